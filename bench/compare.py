@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Compares a bench --json run against a stored baseline and fails on regressions.
+
+Usage:
+    bench --json current.json
+    bench/compare.py baseline.json current.json [--threshold 10] [--alloc-threshold 0]
+    bench/compare.py --save current.json baseline.json
+
+A benchmark regresses when its ns/op grows by more than --threshold percent, or its allocations per op grow by more
+than --alloc-threshold percent. Exits 1 if anything regressed, 2 on bad input. Baselines are machine specific, so
+record one per machine (bench/*.json is ignored by git) rather than committing it.
+"""
+
+import argparse
+import json
+import shutil
+import sys
+
+
+def load(path):
+    try:
+        with open(path) as fp:
+            return {bench["name"]: bench for bench in json.load(fp)["benchmarks"]}
+    except (OSError, ValueError, KeyError) as err:
+        print(f"Failed to read {path}: {err}", file=sys.stderr)
+        sys.exit(2)
+
+
+def change(old, new):
+    if old == 0:
+        return 0.0 if new == 0 else float("inf")
+    return (new - old) / old * 100
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare bench results against a baseline.")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10, help="allowed ns/op increase in percent")
+    parser.add_argument("--alloc-threshold", type=float, default=0, help="allowed allocs/op increase in percent")
+    parser.add_argument("--save", action="store_true", help="copy the first file over the second and exit")
+    args = parser.parse_args()
+
+    if args.save:
+        load(args.baseline)
+        shutil.copyfile(args.baseline, args.current)
+        print(f"Saved {args.baseline} as baseline {args.current}")
+        return 0
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressed = []
+    print(f"{'benchmark':<24}{'base ns/op':>14}{'ns/op':>14}{'change':>10}{'base allocs':>14}{'allocs':>10}")
+    for name, bench in current.items():
+        if name not in baseline:
+            print(f"{name:<24}{'-':>14}{bench['ns_per_op']:>14.1f}{'new':>10}")
+            continue
+
+        base = baseline[name]
+        time_change = change(base["ns_per_op"], bench["ns_per_op"])
+        alloc_change = change(base["allocs_per_op"], bench["allocs_per_op"])
+
+        flags = []
+        if time_change > args.threshold:
+            flags.append("time")
+        if alloc_change > args.alloc_threshold:
+            flags.append("allocs")
+        if flags:
+            regressed.append(name)
+
+        print(f"{name:<24}{base['ns_per_op']:>14.1f}{bench['ns_per_op']:>14.1f}{time_change:>+9.1f}%"
+              f"{base['allocs_per_op']:>14.2f}{bench['allocs_per_op']:>10.2f}"
+              + (f"  REGRESSED ({', '.join(flags)})" if flags else ""))
+
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<24}missing from {args.current}")
+
+    if regressed:
+        print(f"\n{len(regressed)} regression(s): {', '.join(regressed)}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
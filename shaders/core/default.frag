@@ -0,0 +1,10 @@
+#version 450 core
+
+in vec2 texCoord;
+out vec4 fragColor;
+
+layout(binding = 0) uniform sampler2D texSlot;
+
+void main() {
+    fragColor = texture(texSlot, texCoord);
+}
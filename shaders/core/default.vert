@@ -0,0 +1,19 @@
+#version 450 core
+layout(location = 0) in vec3 pos;
+layout(location = 1) in vec2 inTexCoord;
+
+out vec2 texCoord;
+
+uniform mat4 model;
+
+layout(std140, binding = 0) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = projection * view * model * vec4(pos, 1.0);
+    texCoord = inTexCoord;
+}
@@ -0,0 +1,16 @@
+#version 450 core
+layout(location = 0) in vec3 pos;
+
+uniform mat4 model;
+
+layout(std140, binding = 0) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
+
+// Must match default.vert exactly so the color pass lands on the same depths with GL_LEQUAL
+invariant gl_Position;
+
+void main() {
+    gl_Position = projection * view * model * vec4(pos, 1.0);
+}
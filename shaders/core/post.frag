@@ -0,0 +1,36 @@
+#version 450 core
+
+in vec2 texCoord;
+out vec4 fragColor;
+
+layout(binding = 0) uniform sampler2D texSlot;
+
+const float offset = 1.0 / 300.0;
+
+const vec2 offsets[9] = vec2[](
+vec2(-offset, offset), // top-left
+vec2(0.0f, offset), // top-center
+vec2(offset, offset), // top-right
+vec2(-offset, 0.0f), // center-left
+vec2(0.0f, 0.0f), // center-center
+vec2(offset, 0.0f), // center-right
+vec2(-offset, -offset), // bottom-left
+vec2(0.0f, -offset), // bottom-center
+vec2(offset, -offset)// bottom-right
+);
+
+uniform float kernel[9] = float[](0, 0, 0, 0, 1, 0, 0, 0, 0);
+
+void main() {
+    vec3 sampleTex[9];
+    for (int i = 0; i < 9; i++) {
+        sampleTex[i] = vec3(texture(texSlot, texCoord.st + offsets[i]));
+    }
+
+    vec3 col = vec3(0.0);
+    for (int i = 0; i < 9; i++) {
+        col += sampleTex[i] * kernel[i];
+    }
+
+    fragColor = vec4(col, 1.0);
+}
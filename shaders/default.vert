@@ -8,6 +8,8 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+invariant gl_Position;
+
 void main() {
     gl_Position = projection * view * model * vec4(pos, 1.0);
     texCoord = inTexCoord;
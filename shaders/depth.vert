@@ -0,0 +1,13 @@
+#version 120
+attribute vec3 pos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// Must match default.vert exactly so the color pass lands on the same depths with GL_LEQUAL
+invariant gl_Position;
+
+void main() {
+    gl_Position = projection * view * model * vec4(pos, 1.0);
+}
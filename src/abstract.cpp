@@ -2,8 +2,13 @@
 // Created by grant on 5/8/20.
 //
 
+#pragma once
+
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,14 +17,30 @@
 #include <al.h>
 #include <alc.h>
 
-#define STB_IMAGE_IMPLEMENTATION
+// Implementations live in engine.cpp
+#define STB_VORBIS_HEADER_ONLY
 
 #include <stb/stb_image.h>
 #include <stb/stb_vorbis.c>
 #include <fstream>
+#include <filesystem>
 #include "glm/gtx/euler_angles.hpp"
 
-void flushErrors(const std::string &msg) {
+#include "ktx.h"
+#include "mappedfile.h"
+#include "trace.h"
+
+// Which set of GL entry points the wrappers below use. Picked once in main() after the context is created.
+// Legacy targets GL 2.1 (bind-to-edit, glTexImage2D, fixed attribute bindings); Core45 targets a 4.5 core context with
+// direct state access, immutable storage and uniform buffers.
+enum class GLBackend {
+    Legacy,
+    Core45
+};
+
+inline GLBackend glBackend = GLBackend::Legacy;
+
+inline void flushErrors(const std::string &msg) {
 
     GLenum err = 1;
     while (err != GL_NO_ERROR) {
@@ -30,6 +51,54 @@ void flushErrors(const std::string &msg) {
     }
 }
 
+// Global state changes main() makes directly. Routed through here so a capture sees them too.
+inline void setCapability(GLenum cap, bool enabled) {
+    if (enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+    if (glTrace) {
+        glTrace->capability(cap, enabled);
+    }
+}
+
+inline void clearFramebuffer(GLbitfield mask) {
+    glClear(mask);
+    if (glTrace) {
+        glTrace->clear(mask);
+    }
+}
+
+inline void setViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    glViewport(x, y, width, height);
+    if (glTrace) {
+        glTrace->viewport(x, y, width, height);
+    }
+}
+
+inline void setDepthFunc(GLenum func) {
+    glDepthFunc(func);
+    if (glTrace) {
+        glTrace->depthFunc(func);
+    }
+}
+
+inline void setDepthMask(bool enabled) {
+    glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    if (glTrace) {
+        glTrace->depthMask(enabled);
+    }
+}
+
+inline void setColorMask(bool enabled) {
+    GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+    glColorMask(mask, mask, mask, mask);
+    if (glTrace) {
+        glTrace->colorMask(enabled);
+    }
+}
+
 template<typename T, GLenum type>
 class GenericBuffer {
 protected:
@@ -38,13 +107,28 @@ public:
     GenericBuffer() = default;
 
     explicit GenericBuffer(std::vector<T> &contents) {
-        glGenBuffers(1, &id);
-        bind();
-        glBufferData(type, contents.size() * sizeof(T), contents.data(), GL_STATIC_DRAW);
+        if (glBackend == GLBackend::Core45) {
+            glCreateBuffers(1, &id);
+            glNamedBufferStorage(id, contents.size() * sizeof(T), contents.data(), 0);
+        } else {
+            glGenBuffers(1, &id);
+            bind();
+            glBufferData(type, contents.size() * sizeof(T), contents.data(), GL_STATIC_DRAW);
+        }
+        if (glTrace) {
+            glTrace->createBuffer(id, type, contents.data(), contents.size() * sizeof(T));
+        }
     }
 
     inline void bind() const {
         glBindBuffer(type, id);
+        if (glTrace) {
+            glTrace->bindBuffer(type, id);
+        }
+    }
+
+    [[nodiscard]] inline GLuint getId() const {
+        return id;
     }
 
     virtual ~GenericBuffer() {
@@ -62,26 +146,93 @@ public:
             count(contents.size()) {};
 
     void draw(int instances = 1) {
-        bind();
+        // On Core45 the bound VAO already holds its element buffer (see VAO::attach)
+        if (glBackend != GLBackend::Core45) {
+            bind();
+        }
         // for (int i = 0; i < instances; i++) {
             glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
         // }
+        if (glTrace) {
+            glTrace->drawElements(count);
+        }
     }
 };
 
+// Small uniform block that gets rewritten wholesale, e.g. the camera matrices. Core45 only.
+template<typename T>
+class UniformBuffer {
+private:
+    GLuint id{};
+    GLuint binding{};
+
+public:
+    explicit UniformBuffer(GLuint binding) : binding(binding) {
+        glCreateBuffers(1, &id);
+        glNamedBufferStorage(id, sizeof(T), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, id);
+        if (glTrace) {
+            glTrace->createUniformBuffer(id, binding, sizeof(T));
+        }
+    }
+
+    UniformBuffer(const UniformBuffer &) = delete;
+
+    UniformBuffer &operator=(const UniformBuffer &) = delete;
+
+    inline void set(const T &val) const {
+        glNamedBufferSubData(id, 0, sizeof(T), &val);
+        if (glTrace) {
+            glTrace->uniformBufferData(id, &val, sizeof(T));
+        }
+    }
+
+    ~UniformBuffer() {
+        glDeleteBuffers(1, &id);
+    }
+};
+
+// Matches the std140 `Camera` block in shaders/core/default.vert
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+
 class VAO {
 protected:
-    // GLuint id{};
+    GLuint id{}; // Core45 only; the legacy path re-specifies pointers on every bind
     std::vector<unsigned> attribs;
     GLsizei stride{};
 
+    [[nodiscard]] std::vector<uint32_t> layout() const {
+        std::vector<uint32_t> out;
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < attribs.size(); i++) {
+            out.insert(out.end(), {i, attribs[i], offset});
+            offset += attribs[i] * sizeof(float);
+        }
+        return out;
+    }
+
 public:
     VAO() {
-        // glGenVertexArrays(1, &id);
+        if (glBackend == GLBackend::Core45) {
+            glCreateVertexArrays(1, &id);
+            if (glTrace) {
+                glTrace->createVertexArray(id);
+            }
+        }
     }
 
     inline void bind() const {
-        // glBindVertexArray(id);
+        if (glBackend == GLBackend::Core45) {
+            // The layout and buffers were recorded by attach(); the VAO remembers them.
+            glBindVertexArray(id);
+            if (glTrace) {
+                glTrace->bindVertexArray(id);
+            }
+            return;
+        }
 
         finalize();
     }
@@ -91,18 +242,57 @@ public:
         stride += sizeof(float) * qty;
     }
 
+    /**
+     * Ties the pushed layout to `vbo` and `ibo`. Core45 records it in the VAO with DSA, so nothing has to be bound.
+     * The legacy path has no VAO object and re-specifies pointers against the bound VBO on every bind() instead.
+     */
+    template<typename T>
+    void attach(const GenericBuffer<T, GL_ARRAY_BUFFER> &vbo, const IBO &ibo) const {
+        if (glBackend != GLBackend::Core45) {
+            return;
+        }
+
+        std::vector<uint32_t> attribLayout = layout();
+        glVertexArrayVertexBuffer(id, 0, vbo.getId(), 0, stride);
+        for (size_t i = 0; i < attribLayout.size(); i += 3) {
+            glEnableVertexArrayAttrib(id, attribLayout[i]);
+            glVertexArrayAttribFormat(id, attribLayout[i], attribLayout[i + 1], GL_FLOAT, GL_FALSE,
+                                      attribLayout[i + 2]);
+            glVertexArrayAttribBinding(id, attribLayout[i], 0);
+        }
+        glVertexArrayElementBuffer(id, ibo.getId());
+        if (glTrace) {
+            glTrace->vertexArrayLayout(id, vbo.getId(), ibo.getId(), stride, attribLayout);
+        }
+    }
+
+    // Legacy path: points the attributes at the currently bound GL_ARRAY_BUFFER.
     void finalize(int inc = 1) const {
-        // bind();
+        if (glBackend == GLBackend::Core45) {
+            glBindVertexArray(id);
+            if (glTrace) {
+                glTrace->bindVertexArray(id);
+            }
+        }
+        std::vector<uint32_t> traced;
         GLsizei ptr = 0;
         for (GLuint i = 0; i < (attribs.size() * inc); i += inc) {
             glEnableVertexAttribArray(i);
             glVertexAttribPointer(i, attribs[i], GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(ptr));
+            if (glTrace) {
+                traced.insert(traced.end(), {i, attribs[i], static_cast<uint32_t>(ptr)});
+            }
             ptr += attribs[i] * sizeof(float);
         }
+        if (glTrace) {
+            glTrace->attribPointers(stride, traced);
+        }
     }
 
     virtual ~VAO() {
-        // glDeleteVertexArrays(1, &id);
+        if (glBackend == GLBackend::Core45) {
+            glDeleteVertexArrays(1, &id);
+        }
     }
 };
 
@@ -131,6 +321,9 @@ public:
         fp.close();
 
         id = glCreateShader(isVert ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER);
+        if (glTrace) {
+            glTrace->shaderSource(id, isVert, contents);
+        }
 
         auto srcCStr = contents.c_str();
         glShaderSource(id, 1, &srcCStr, nullptr);
@@ -160,22 +353,37 @@ private:
 public:
     ShaderProgram() {
         id = glCreateProgram();
+        if (glTrace) {
+            glTrace->createProgram(id);
+        }
     }
 
     inline void attach(Shader &shader) const {
         glAttachShader(id, shader.id);
+        if (glTrace) {
+            glTrace->attachShader(id, shader.id);
+        }
     }
 
     inline void link() const {
         glLinkProgram(id);
+        if (glTrace) {
+            glTrace->linkProgram(id);
+        }
     }
 
     inline void bind() const {
         glUseProgram(id);
+        if (glTrace) {
+            glTrace->useProgram(id);
+        }
     }
 
     inline void bindAttribLoc(GLuint idx, const GLchar *name) const {
         glBindAttribLocation(id, idx, name);
+        if (glTrace) {
+            glTrace->bindAttribLocation(id, idx, name);
+        }
     }
 
     ~ShaderProgram() {
@@ -183,21 +391,34 @@ public:
     }
 
     [[nodiscard]] inline UniformLocation getLocation(const std::string &in) const {
-        return glGetUniformLocation(id, in.c_str());
+        UniformLocation loc = glGetUniformLocation(id, in.c_str());
+        if (glTrace) {
+            glTrace->uniformLocation(id, in, loc);
+        }
+        return loc;
     }
 
     static inline void setMat4(UniformLocation in, glm::mat4 val) {
         glUniformMatrix4fv(in, 1, GL_FALSE, glm::value_ptr(val));
+        if (glTrace) {
+            glTrace->uniformMat4(in, glm::value_ptr(val));
+        }
     }
 
     static inline void setFv(UniformLocation in, GLfloat *val, GLsizei num) {
         flushErrors("Pre fv");
         glUniform1fv(in, num, val);
         flushErrors("Post fv");
+        if (glTrace) {
+            glTrace->uniform1fv(in, val, num);
+        }
     }
 
     static inline void set1i(UniformLocation in, GLint val) {
         glUniform1i(in, val);
+        if (glTrace) {
+            glTrace->uniform1i(in, val);
+        }
     }
 };
 
@@ -208,6 +429,13 @@ private:
     glm::mat4 view;
     glm::mat4 proj;
 
+    // Inputs the cached matrices were last built from. pos and euler are public, so compare instead of flagging.
+    glm::vec3 viewPos{};
+    glm::vec3 viewEuler{};
+    glm::vec4 projParams{};
+    bool viewValid = false;
+    bool projValid = false;
+
 public:
     glm::vec3 pos;
     glm::vec3 euler;
@@ -226,7 +454,17 @@ public:
         this->pos = newPos;
     }
 
+    /**
+     * Rebuilds the view matrix and basis vectors. Does nothing if pos and euler haven't changed since the last call.
+     */
     inline void updateViewMat() {
+        if (viewValid && pos == viewPos && euler == viewEuler) {
+            return;
+        }
+        viewPos = pos;
+        viewEuler = euler;
+        viewValid = true;
+
         view = glm::eulerAngleXYZ(euler.x, euler.y, euler.z);
         forward = glm::vec4({0, 0, 1, 0}) * view;
         right = glm::vec4({1, 0, 0, 0}) * view;
@@ -243,6 +481,13 @@ public:
     }
 
     inline void setProj(float fov, float ratio, float zNear = 0.1f, float zFar = 100.0f) {
+        glm::vec4 params = {fov, ratio, zNear, zFar};
+        if (projValid && params == projParams) {
+            return;
+        }
+        projParams = params;
+        projValid = true;
+
         proj = glm::perspective(glm::radians(fov), ratio, zNear, zFar);
     }
 };
@@ -251,31 +496,249 @@ public:
 class Texture {
 private:
     GLuint id{};
+
+    static bool compressionSupported(uint32_t internalFormat) {
+        switch (internalFormat) {
+            case ktxDXT1:
+            case ktxDXT5:
+                return GLEW_EXT_texture_compression_s3tc;
+            case ktxETC2:
+            case ktxETC2EAC:
+                return GLEW_ARB_ES3_compatibility;
+            default:
+                return false;
+        }
+    }
+
+    // Looks for the output of texcook next to the source image ("foo.jpg" -> "foo.s3tc.ktx", "foo.etc2.ktx",
+    // "foo.ktx"), preferring the compressed variants the driver can sample. Returns "" if nothing up to date was
+    // cooked.
+    static std::string findCooked(const std::string &file) {
+        std::filesystem::path stem = std::filesystem::path(file).replace_extension();
+        std::string base = stem.string();
+
+        // Cooked files aren't rebuilt with the game, so one older than its source is skipped rather than shown stale.
+        auto fresh = [&file](const std::string &cooked) {
+            if (!std::filesystem::exists(cooked)) {
+                return false;
+            }
+            std::error_code err;
+            auto sourceTime = std::filesystem::last_write_time(file, err);
+            if (!err && std::filesystem::last_write_time(cooked) < sourceTime) {
+                std::cerr << "Ignoring " << cooked << ", it is older than " << file << " (rebuild cook_textures)"
+                          << std::endl;
+                return false;
+            }
+            return true;
+        };
+
+        if (GLEW_EXT_texture_compression_s3tc && fresh(base + ".s3tc.ktx")) {
+            return base + ".s3tc.ktx";
+        }
+        if (GLEW_ARB_ES3_compatibility && fresh(base + ".etc2.ktx")) {
+            return base + ".etc2.ktx";
+        }
+        if (fresh(base + ".ktx")) {
+            return base + ".ktx";
+        }
+        return "";
+    }
+
+    inline void setParam(GLenum pname, GLint val) const {
+        if (glBackend == GLBackend::Core45) {
+            glTextureParameteri(id, pname, val);
+        } else {
+            glTexParameteri(GL_TEXTURE_2D, pname, val);
+        }
+        if (glTrace) {
+            glTrace->texParam(id, pname, val);
+        }
+    }
+
+    // Uploads every mip level straight out of the mapping. Returns the number of levels.
+    GLint loadKtx(const std::string &file) const {
+        MappedFile map(file);
+        if (map.size() < sizeof(KtxHeader)) {
+            throw std::runtime_error("Truncated KTX: " + file);
+        }
+
+        KtxHeader header{};
+        std::memcpy(&header, map.data(), sizeof(KtxHeader));
+
+        if (std::memcmp(header.identifier, ktxIdentifier, sizeof(ktxIdentifier)) != 0) {
+            throw std::runtime_error("Not a KTX file: " + file);
+        }
+        if (header.endianness != ktxEndianRef) {
+            throw std::runtime_error("KTX has foreign endianness: " + file);
+        }
+        if (header.pixelDepth > 1 || header.numberOfArrayElements > 0 || header.numberOfFaces != 1) {
+            throw std::runtime_error("Only plain 2D KTX textures are supported: " + file);
+        }
+
+        bool compressed = header.glType == 0;
+        if (compressed && !compressionSupported(header.glInternalFormat)) {
+            throw std::runtime_error("KTX format not supported by this driver: " + file);
+        }
+
+        GLint levels = header.numberOfMipmapLevels == 0 ? 1 : static_cast<GLint>(header.numberOfMipmapLevels);
+        size_t offset = sizeof(KtxHeader) + header.bytesOfKeyValueData;
+
+        bool core = glBackend == GLBackend::Core45;
+        if (core) {
+            glTextureStorage2D(id, levels, header.glInternalFormat, header.pixelWidth, header.pixelHeight);
+            if (glTrace) {
+                glTrace->texStorage(id, levels, header.glInternalFormat, header.pixelWidth, header.pixelHeight);
+            }
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // KTX rows are 4 byte aligned
+        for (GLint level = 0; level < levels; level++) {
+            uint32_t imageSize;
+            if (offset + sizeof(imageSize) > map.size()) {
+                throw std::runtime_error("Truncated KTX: " + file);
+            }
+            std::memcpy(&imageSize, map.data() + offset, sizeof(imageSize));
+            offset += sizeof(imageSize);
+            if (offset + imageSize > map.size()) {
+                throw std::runtime_error("Truncated KTX: " + file);
+            }
+
+            GLsizei w = std::max(1u, header.pixelWidth >> level);
+            GLsizei h = std::max(1u, header.pixelHeight >> level);
+
+            // GL reads however many bytes the format and size call for, whatever imageSize says, so a short level
+            // would have the driver read past the mapping.
+            uint64_t expected = ktxLevelSize(header, w, h);
+            if (expected == 0) {
+                throw std::runtime_error("Unsupported KTX format: " + file);
+            }
+            if (imageSize < expected) {
+                throw std::runtime_error("Truncated KTX: " + file);
+            }
+            const void *pixels = map.data() + offset;
+
+            if (core && compressed) {
+                glCompressedTextureSubImage2D(id, level, 0, 0, w, h, header.glInternalFormat, imageSize, pixels);
+            } else if (core) {
+                glTextureSubImage2D(id, level, 0, 0, w, h, header.glFormat, header.glType, pixels);
+            } else if (compressed) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, header.glInternalFormat, w, h, 0, imageSize, pixels);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, level, header.glInternalFormat, w, h, 0, header.glFormat,
+                             header.glType, pixels);
+            }
+            if (glTrace) {
+                uint8_t flags = (compressed ? traceTexCompressed : 0) | (core ? traceTexSubImage : 0);
+                glTrace->texImage(id, level, header.glInternalFormat, w, h, header.glFormat, header.glType, flags, 4,
+                                  pixels, imageSize);
+            }
+            offset += ktxPad4(imageSize);
+        }
+
+        return levels;
+    }
+
+    // Fallback for textures that haven't been run through texcook. Decodes on this thread and lets the driver
+    // build the mip chain.
+    GLint loadImage(const std::string &file) const {
+        bool core = glBackend == GLBackend::Core45;
+
+        // Core profiles have no luminance formats, so expand everything to RGBA there.
+        int width, height, nrChannels;
+        unsigned char *data = stbi_load(file.c_str(), &width, &height, &nrChannels, core ? 4 : 0);
+        if (!data) {
+            throw std::runtime_error("Failed to load texture: " + file);
+        }
+        GLint levels = 1 + static_cast<GLint>(std::log2(std::max(width, height)));
+
+        if (core) {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTextureStorage2D(id, levels, GL_RGBA8, width, height);
+            glTextureSubImage2D(id, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            if (glTrace) {
+                glTrace->texStorage(id, levels, GL_RGBA8, width, height);
+                glTrace->texImage(id, 0, GL_RGBA8, width, height, GL_RGBA, GL_UNSIGNED_BYTE, traceTexSubImage, 1,
+                                  data, width * height * 4);
+            }
+            stbi_image_free(data);
+
+            glGenerateTextureMipmap(id);
+            if (glTrace) {
+                glTrace->generateMipmap(id);
+            }
+            return levels;
+        }
+
+        GLenum format;
+        switch (nrChannels) {
+            case 1: format = GL_LUMINANCE; break;
+            case 2: format = GL_LUMINANCE_ALPHA; break;
+            case 3: format = GL_RGB; break;
+            default: format = GL_RGBA; break;
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // stb rows are tightly packed
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (glTrace) {
+            glTrace->texImage(id, 0, format, width, height, format, GL_UNSIGNED_BYTE, 0, 1, data,
+                              width * height * nrChannels);
+        }
+        stbi_image_free(data);
+
+        glGenerateMipmap(GL_TEXTURE_2D);
+        if (glTrace) {
+            glTrace->generateMipmap(id);
+        }
+        return levels;
+    }
+
 public:
     Texture() = default;
 
+    /**
+     * Loads `file`, or the cooked KTX next to it if texcook has been run. Passing a .ktx directly skips the lookup.
+     */
     explicit Texture(const std::string &file, bool antiAlias = false) {
-        int width, height, nrChannels;
-        unsigned char *data = stbi_load(file.c_str(), &width, &height, &nrChannels, 0);
+        std::string cooked = std::filesystem::path(file).extension() == ".ktx" ? file : findCooked(file);
 
-        glGenTextures(1, &id);
-        bind();
+        if (glBackend == GLBackend::Core45) {
+            glCreateTextures(GL_TEXTURE_2D, 1, &id);
+        } else {
+            glGenTextures(1, &id);
+        }
+        if (glTrace) {
+            glTrace->createTexture(id);
+        }
+        if (glBackend != GLBackend::Core45) {
+            bind();
+        }
+
+        setParam(GL_TEXTURE_WRAP_S, GL_REPEAT);
+        setParam(GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, antiAlias ? GL_LINEAR : GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, antiAlias ? GL_LINEAR : GL_NEAREST);
+        GLint levels = cooked.empty() ? loadImage(file) : loadKtx(cooked);
 
-        if (data) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+        GLint minFilter;
+        if (levels > 1) {
+            minFilter = antiAlias ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
         } else {
-            throw std::runtime_error("Failed to load texture: " + file);
+            minFilter = antiAlias ? GL_LINEAR : GL_NEAREST;
         }
-
+        setParam(GL_TEXTURE_MAX_LEVEL, levels - 1);
+        setParam(GL_TEXTURE_MIN_FILTER, minFilter);
+        setParam(GL_TEXTURE_MAG_FILTER, antiAlias ? GL_LINEAR : GL_NEAREST);
     }
 
     inline void bind() const {
+        if (glTrace) {
+            glTrace->bindTexture(id);
+        }
+        if (glBackend == GLBackend::Core45) {
+            glBindTextureUnit(0, id);
+            return;
+        }
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, id);
     }
@@ -295,9 +758,34 @@ public:
     int height;
 
     Framebuffer(int width, int height) : width(width), height(height) {
+        if (glBackend == GLBackend::Core45) {
+            glCreateFramebuffers(1, &id);
+            glCreateTextures(GL_TEXTURE_2D, 1, &tex);
+            glCreateRenderbuffers(1, &rbo);
+            if (glTrace) {
+                glTrace->createFramebuffer(id, tex, rbo, width, height);
+            }
+
+            glNamedRenderbufferStorage(rbo, GL_DEPTH24_STENCIL8, width, height);
+            glNamedFramebufferRenderbuffer(id, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+
+            glTextureStorage2D(tex, 1, GL_RGB8, width, height);
+            glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glNamedFramebufferTexture(id, GL_COLOR_ATTACHMENT0, tex, 0);
+
+            if (glCheckNamedFramebufferStatus(id, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                throw std::runtime_error("Framebuffer incomplete!");
+            }
+            return;
+        }
+
         glGenFramebuffers(1, &id);
         glGenTextures(1, &tex);
         glGenRenderbuffers(1, &rbo);
+        if (glTrace) {
+            glTrace->createFramebuffer(id, tex, rbo, width, height);
+        }
 
         bind();
 
@@ -318,15 +806,28 @@ public:
 
     inline void bind() const {
         glBindFramebuffer(GL_FRAMEBUFFER, id);
+        if (glTrace) {
+            glTrace->bindFramebuffer(id);
+        }
     }
 
     inline void bindTex() const {
+        if (glTrace) {
+            glTrace->bindTexture(tex);
+        }
+        if (glBackend == GLBackend::Core45) {
+            glBindTextureUnit(0, tex);
+            return;
+        }
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, tex);
     }
 
     static inline void bindDefault() {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (glTrace) {
+            glTrace->bindFramebuffer(0);
+        }
     }
 
     Framebuffer &operator=(Framebuffer &&rhs) noexcept {
@@ -365,11 +866,15 @@ private:
     friend class ALSrc;
 
 public:
+    float duration{}; // seconds
+
     explicit ALBuf(const std::string &filename) {
         short *data;
         int channels, sampleRate;
-        alGenBuffers(1, &id);
         int len = stb_vorbis_decode_filename(filename.c_str(), &channels, &sampleRate, &data);
+        if (len < 0) {
+            throw std::runtime_error("Failed to decode " + filename);
+        }
         alGenBuffers(1, &id);
 
         if (channels > 1) {
@@ -377,6 +882,9 @@ public:
         } else {
             alBufferData(id, AL_FORMAT_MONO16, data, len * sizeof(short), sampleRate);
         }
+        free(data);
+
+        duration = static_cast<float>(len) / static_cast<float>(sampleRate);
     }
 
     ~ALBuf() {
@@ -393,9 +901,9 @@ public:
         alGenSources(1, &id);
         alSourcef(id, AL_PITCH, 1);
         alSourcef(id, AL_GAIN, 1);
-        alSource3f(id, AL_POSITION, -4, -8, 0);
-        alSource3f(id, AL_VELOCITY, 1, 1, 1);
-        alSourcei(id, AL_LOOPING, AL_TRUE);
+        alSource3f(id, AL_POSITION, 0, 0, 0);
+        alSource3f(id, AL_VELOCITY, 0, 0, 0);
+        alSourcei(id, AL_LOOPING, AL_FALSE);
     }
 
     ~ALSrc() {
@@ -403,10 +911,41 @@ public:
     }
 
     void bind(ALBuf *buf) const {
-        alSourcei(id, AL_BUFFER, buf->id);
+        alSourcei(id, AL_BUFFER, buf ? buf->id : 0);
     }
 
     void play() const {
         alSourcePlay(id);
     }
-};
\ No newline at end of file
+
+    void stop() const {
+        alSourceStop(id);
+    }
+
+    inline void setPos(glm::vec3 pos) const {
+        alSource3f(id, AL_POSITION, pos.x, pos.y, pos.z);
+    }
+
+    inline void setGain(float gain) const {
+        alSourcef(id, AL_GAIN, gain);
+    }
+
+    inline void setLooping(bool looping) const {
+        alSourcei(id, AL_LOOPING, looping ? AL_TRUE : AL_FALSE);
+    }
+
+    inline void setDistances(float refDist, float maxDist) const {
+        alSourcef(id, AL_REFERENCE_DISTANCE, refDist);
+        alSourcef(id, AL_MAX_DISTANCE, maxDist);
+    }
+
+    inline void setOffset(float seconds) const {
+        alSourcef(id, AL_SEC_OFFSET, seconds);
+    }
+
+    [[nodiscard]] inline float getOffset() const {
+        float seconds = 0;
+        alGetSourcef(id, AL_SEC_OFFSET, &seconds);
+        return seconds;
+    }
+};
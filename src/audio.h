@@ -0,0 +1,273 @@
+// Spatial audio. Any number of logical emitters live at scene positions, but only the most audible ones are backed
+// by one of a fixed pool of real OpenAL sources ("voices"). The rest are virtual: they keep advancing their playback
+// clock so they pick up at the right spot if they become audible again.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <al.h>
+#include <alc.h>
+
+#include <abstract.cpp>
+
+typedef unsigned EmitterHandle;
+
+class VoiceManager {
+private:
+    static constexpr EmitterHandle noEmitter = ~0u;
+
+    // Voiced emitters get this much extra score so two emitters at nearly the same distance don't trade a voice
+    // back and forth every frame.
+    static constexpr float voicedBias = 1.25f;
+
+    struct Emitter {
+        glm::vec3 pos{};
+        ALBuf *buf{};
+        float gain = 1;
+        float priority = 1;
+        float refDist = 1;
+        float maxDist = 64;
+        float time = 0; // virtual playback position in seconds
+        int voice = -1;
+        unsigned audibleFrame{};
+        bool looping = true;
+        bool playing = false;
+        bool alive = false;
+        bool dirty = false; // pos or gain changed since it was last pushed to its voice
+    };
+
+    std::unique_ptr<ALSrc[]> voices;
+    std::vector<EmitterHandle> voiceOwner;
+    std::vector<int> freeVoices;
+
+    std::vector<Emitter> emitters;
+    std::vector<EmitterHandle> freeEmitters;
+
+    // update()'s ranking buffer, reused across frames
+    std::vector<std::pair<float, EmitterHandle>> candidates;
+
+    int voiceCount;
+    unsigned frame{};
+
+    void releaseVoice(Emitter &emitter) {
+        if (emitter.voice < 0) {
+            return;
+        }
+
+        const ALSrc &src = voices[emitter.voice];
+        if (emitter.buf && emitter.buf->duration > 0) {
+            // The source's own clock is more accurate than our dt sum
+            emitter.time = src.getOffset();
+        }
+        src.stop();
+        src.bind(nullptr);
+
+        voiceOwner[emitter.voice] = noEmitter;
+        freeVoices.emplace_back(emitter.voice);
+        emitter.voice = -1;
+    }
+
+    void acquireVoice(EmitterHandle handle) {
+        Emitter &emitter = emitters[handle];
+        int voice = freeVoices.back();
+        freeVoices.pop_back();
+
+        const ALSrc &src = voices[voice];
+        src.bind(emitter.buf);
+        src.setLooping(emitter.looping);
+        src.setDistances(emitter.refDist, emitter.maxDist);
+        src.setGain(emitter.gain);
+        src.setPos(emitter.pos);
+        src.setOffset(emitter.time);
+        src.play();
+
+        voiceOwner[voice] = handle;
+        emitter.voice = voice;
+        emitter.dirty = false;
+    }
+
+public:
+    /**
+     * @param dev The device, used to ask how many mono sources the implementation can mix. May be null.
+     * @param maxVoices Upper bound on real sources to allocate.
+     */
+    explicit VoiceManager(ALCdevice *dev, int maxVoices = 32) : voiceCount(maxVoices) {
+        if (dev) {
+            ALCint monoSources = 0;
+            alcGetIntegerv(dev, ALC_MONO_SOURCES, 1, &monoSources);
+            if (monoSources > 0) {
+                voiceCount = std::min(voiceCount, static_cast<int>(monoSources));
+            }
+        }
+
+        alDistanceModel(AL_INVERSE_DISTANCE_CLAMPED);
+        alListener3f(AL_VELOCITY, 0, 0, 0);
+
+        voices = std::make_unique<ALSrc[]>(voiceCount);
+        voiceOwner.assign(voiceCount, noEmitter);
+        for (int i = voiceCount - 1; i >= 0; i--) {
+            freeVoices.emplace_back(i);
+        }
+    }
+
+    VoiceManager(const VoiceManager &) = delete;
+
+    VoiceManager &operator=(const VoiceManager &) = delete;
+
+    EmitterHandle createEmitter(ALBuf *buf, glm::vec3 pos, bool looping = true, float priority = 1) {
+        EmitterHandle handle;
+        if (freeEmitters.empty()) {
+            handle = emitters.size();
+            emitters.emplace_back();
+        } else {
+            handle = freeEmitters.back();
+            freeEmitters.pop_back();
+            emitters[handle] = Emitter();
+        }
+
+        Emitter &emitter = emitters[handle];
+        emitter.buf = buf;
+        emitter.pos = pos;
+        emitter.looping = looping;
+        emitter.priority = priority;
+        emitter.alive = true;
+        return handle;
+    }
+
+    void destroyEmitter(EmitterHandle handle) {
+        releaseVoice(emitters[handle]);
+        emitters[handle].alive = false;
+        freeEmitters.emplace_back(handle);
+    }
+
+    inline void play(EmitterHandle handle) {
+        emitters[handle].playing = true;
+        emitters[handle].time = 0;
+        if (emitters[handle].voice >= 0) {
+            voices[emitters[handle].voice].setOffset(0);
+        }
+    }
+
+    inline void stop(EmitterHandle handle) {
+        releaseVoice(emitters[handle]);
+        emitters[handle].playing = false;
+    }
+
+    inline void setPos(EmitterHandle handle, glm::vec3 pos) {
+        emitters[handle].pos = pos;
+        emitters[handle].dirty = true;
+    }
+
+    inline void setGain(EmitterHandle handle, float gain) {
+        emitters[handle].gain = gain;
+        emitters[handle].dirty = true;
+    }
+
+    inline void setDistances(EmitterHandle handle, float refDist, float maxDist) {
+        emitters[handle].refDist = refDist;
+        emitters[handle].maxDist = maxDist;
+        if (emitters[handle].voice >= 0) {
+            voices[emitters[handle].voice].setDistances(refDist, maxDist);
+        }
+    }
+
+    [[nodiscard]] inline bool isVoiced(EmitterHandle handle) const {
+        return emitters[handle].voice >= 0;
+    }
+
+    [[nodiscard]] inline int getVoiceCount() const {
+        return voiceCount;
+    }
+
+    [[nodiscard]] inline int getActiveVoices() const {
+        return voiceCount - static_cast<int>(freeVoices.size());
+    }
+
+    [[nodiscard]] inline size_t getEmitterCount() const {
+        return emitters.size() - freeEmitters.size();
+    }
+
+    /**
+     * Call once per frame. Moves the listener to the camera, advances virtual emitters by `dt` seconds and hands the
+     * voices to the most audible emitters. All AL state changes for the frame go out as one batch.
+     */
+    void update(const Camera &cam, float dt) {
+        frame++;
+
+        // Camera::pos and Camera::forward are the negated world position and look direction (the view matrix
+        // translates by pos), so flip them back into world space for the listener.
+        glm::vec3 listenerPos = -cam.pos;
+        float ori[6] = {-cam.forward.x, -cam.forward.y, -cam.forward.z,
+                        cam.up.x, cam.up.y, cam.up.z};
+
+        ALCcontext *ctx = alcGetCurrentContext();
+        alcSuspendContext(ctx);
+
+        alListener3f(AL_POSITION, listenerPos.x, listenerPos.y, listenerPos.z);
+        alListenerfv(AL_ORIENTATION, ori);
+
+        candidates.clear();
+        for (EmitterHandle i = 0; i < emitters.size(); i++) {
+            Emitter &emitter = emitters[i];
+            if (!emitter.alive || !emitter.playing) {
+                continue;
+            }
+
+            float duration = emitter.buf ? emitter.buf->duration : 0;
+            emitter.time += dt;
+            if (emitter.time >= duration) {
+                if (!emitter.looping) {
+                    releaseVoice(emitter);
+                    emitter.playing = false;
+                    continue;
+                }
+                emitter.time = duration > 0 ? std::fmod(emitter.time, duration) : 0;
+            }
+
+            // Same shape as AL_INVERSE_DISTANCE_CLAMPED. That model holds the gain at its maxDist value rather than going
+            // silent, so far emitters stay candidates; dropping them would cut the sound off at maxDist.
+            glm::vec3 delta = emitter.pos - listenerPos;
+            float dist = glm::clamp(std::sqrt(glm::dot(delta, delta)), emitter.refDist, emitter.maxDist);
+            float score = emitter.priority * emitter.gain * emitter.refDist / dist;
+            if (emitter.voice >= 0) {
+                score *= voicedBias;
+            }
+            candidates.emplace_back(score, i);
+        }
+
+        if (candidates.size() > static_cast<size_t>(voiceCount)) {
+            std::nth_element(candidates.begin(), candidates.begin() + voiceCount, candidates.end(),
+                             [](const auto &lhs, const auto &rhs) { return lhs.first > rhs.first; });
+            candidates.resize(voiceCount);
+        }
+
+        for (const auto &candidate : candidates) {
+            emitters[candidate.second].audibleFrame = frame;
+        }
+
+        // Free voices held by emitters that fell out of the top N before handing any out
+        for (int voice = 0; voice < voiceCount; voice++) {
+            EmitterHandle owner = voiceOwner[voice];
+            if (owner != noEmitter && emitters[owner].audibleFrame != frame) {
+                releaseVoice(emitters[owner]);
+            }
+        }
+
+        for (const auto &candidate : candidates) {
+            Emitter &emitter = emitters[candidate.second];
+            if (emitter.voice < 0) {
+                acquireVoice(candidate.second);
+            } else if (emitter.dirty) {
+                voices[emitter.voice].setPos(emitter.pos);
+                voices[emitter.voice].setGain(emitter.gain);
+                emitter.dirty = false;
+            }
+        }
+
+        alcProcessContext(ctx);
+    }
+};
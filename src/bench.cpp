@@ -0,0 +1,305 @@
+// CPU benchmarks for the engine's hot paths. Each benchmark is run in batches sized to take at least --min-time
+// seconds, and the median batch is reported so one descheduled batch doesn't skew the result. Run from the repo root
+// so the res/ paths resolve.
+//
+// Usage: bench [--filter <substring>] [--json <file>] [--batches <n>] [--min-time <seconds>]
+// The JSON output is what bench/compare.py reads.
+
+#define STB_VORBIS_HEADER_ONLY
+
+#include <stb/stb_image.h>
+#include <stb/stb_vorbis.c>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <mesh.h>
+#include <renderqueue.h>
+#include <scene.h>
+
+// Every allocation made through operator new bumps this, so each benchmark can report allocations per op. The stb
+// decoders allocate with malloc and aren't counted.
+static std::atomic<size_t> allocCount{0};
+
+void *operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+struct Benchmark {
+    std::string name;
+    std::string unit; // what run() counts, for the throughput column
+    std::function<size_t()> run; // one op; returns how many units it processed
+};
+
+struct Result {
+    std::string name;
+    std::string unit;
+    double nsPerOp;
+    double unitsPerSec;
+    double allocsPerOp;
+    size_t iterations;
+};
+
+// Keeps the optimizer from discarding a result that is otherwise unused.
+template<typename T>
+inline void doNotOptimize(const T &val) {
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+size_t fileSize(const std::string &file) {
+    if (!std::filesystem::exists(file)) {
+        throw std::runtime_error("Failed to read " + file + " (run bench from the repo root)");
+    }
+    return std::filesystem::file_size(file);
+}
+
+SceneGraph makeScene() {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned> indices;
+    loadObj("./res/obj/rick.obj", vertices, indices);
+
+    AABB bounds = {vertices[0].pos, vertices[0].pos};
+    for (const auto &vertex : vertices) {
+        bounds.min = glm::min(bounds.min, vertex.pos);
+        bounds.max = glm::max(bounds.max, vertex.pos);
+    }
+
+    SceneGraph scene;
+    scene.addMesh("cube", {{-1, -1, -1}, {1, 1, 1}});
+    scene.addMesh("rick", bounds);
+    scene.load("./res/scenes/default.scene");
+    scene.update();
+    return scene;
+}
+
+std::vector<Benchmark> makeBenchmarks() {
+    std::vector<Benchmark> benches;
+
+    benches.push_back({"obj_load_rick", "bytes", [] {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned> indices;
+        loadObj("./res/obj/rick.obj", vertices, indices);
+        doNotOptimize(indices.data());
+        static size_t bytes = fileSize("./res/obj/rick.obj");
+        return bytes;
+    }});
+
+    // What main() used to do by hand for modelMats: lay out the cube grid and compute every world matrix.
+    benches.push_back({"scene_load_grid", "nodes", [] {
+        SceneGraph scene;
+        scene.addMesh("cube", {{-1, -1, -1}, {1, 1, 1}});
+        scene.addMesh("rick", {{-1, -1, -1}, {1, 1, 1}});
+        scene.load("./res/scenes/default.scene");
+        scene.update();
+        doNotOptimize(scene.getWorld(0));
+        return scene.size();
+    }});
+
+    benches.push_back({"texture_decode_rick", "pixels", [] {
+        int width, height, nrChannels;
+        unsigned char *data = stbi_load("./res/tex/rick.jpg", &width, &height, &nrChannels, 0);
+        if (!data) {
+            throw std::runtime_error(std::string("Failed to load ./res/tex/rick.jpg: ") + stbi_failure_reason());
+        }
+        doNotOptimize(data[0]);
+        stbi_image_free(data);
+        return static_cast<size_t>(width) * height;
+    }});
+
+    benches.push_back({"vorbis_decode", "samples", [] {
+        int channels, sampleRate;
+        short *data;
+        int samples = stb_vorbis_decode_filename("./res/rick.ogg", &channels, &sampleRate, &data);
+        if (samples < 0) {
+            throw std::runtime_error("Failed to decode ./res/rick.ogg");
+        }
+        doNotOptimize(data[0]);
+        std::free(data);
+        return static_cast<size_t>(samples) * channels;
+    }});
+
+    // The CPU side of one frame: animate, propagate transforms and cull into the draw list.
+    benches.push_back({"frame_packet", "nodes", [] {
+        static SceneGraph scene = makeScene();
+        static NodeHandle rickNode = scene.find("rick");
+        static glm::mat4 rickBase = scene.getLocal(rickNode);
+        static glm::mat4 viewProj = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 1000.0f) *
+                                    glm::translate(glm::mat4(1.0f), glm::vec3(0, -8, -96));
+        static std::vector<std::pair<int, const glm::mat4 *>> visible;
+        static float yaw = 0;
+
+        yaw += 0.0625f;
+        scene.setLocal(rickNode, rickBase * glm::eulerAngleYXZ(yaw, 0.0f, 0.0f));
+        scene.update();
+
+        visible.clear();
+        scene.collectVisible(viewProj, visible);
+        doNotOptimize(visible.data());
+        return scene.size();
+    }});
+
+    // Building and sorting the draw list for the same view, with the depth pre-pass on so both passes are keyed.
+    benches.push_back({"render_queue", "draws", [] {
+        static SceneGraph scene = makeScene();
+        static glm::mat4 proj = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+        static glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0, -8, -96));
+        static std::vector<std::pair<int, const glm::mat4 *>> visible;
+        static RenderQueue queue;
+
+        if (visible.empty()) {
+            scene.collectVisible(proj * view, visible);
+        }
+
+        queue.clear();
+        for (const auto &[meshId, model] : visible) {
+            float viewDepth = -(view * (*model)[3]).z;
+            queue.submit(RenderPass::DepthPrepass, 1, meshId, viewDepth, meshId, model);
+            queue.submit(RenderPass::Opaque, 0, meshId, viewDepth, meshId, model);
+        }
+        queue.sort();
+        doNotOptimize(queue.getItems().data());
+        return queue.size();
+    }});
+
+    return benches;
+}
+
+Result measure(const Benchmark &bench, int batches, double minTime) {
+    using clock = std::chrono::steady_clock;
+
+    // Warm up caches and any function-local statics, then size a batch so it takes at least minTime.
+    size_t units = bench.run();
+    size_t iterations = 1;
+    while (true) {
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            bench.run();
+        }
+        double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        if (elapsed >= minTime || iterations >= (1u << 30)) {
+            break;
+        }
+        iterations = elapsed > 0 ? std::max(iterations * 2, static_cast<size_t>(iterations * minTime / elapsed * 1.2))
+                                 : iterations * 16;
+    }
+
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(batches);
+    size_t allocsBefore = allocCount.load();
+    for (int batch = 0; batch < batches; batch++) {
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            bench.run();
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        nsPerOp.emplace_back(elapsed / iterations);
+    }
+    size_t allocs = allocCount.load() - allocsBefore;
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    double median = nsPerOp[nsPerOp.size() / 2];
+    return {bench.name, bench.unit, median, units / (median * 1e-9),
+            static_cast<double>(allocs) / (static_cast<double>(iterations) * batches), iterations};
+}
+
+void writeJson(const std::string &file, const std::vector<Result> &results) {
+    std::ofstream fp(file);
+    if (!fp.is_open()) {
+        throw std::runtime_error("Failed to write " + file);
+    }
+
+    fp << std::setprecision(10) << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &result = results[i];
+        fp << "    {\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit
+           << "\", \"ns_per_op\": " << result.nsPerOp << ", \"units_per_sec\": " << result.unitsPerSec
+           << ", \"allocs_per_op\": " << result.allocsPerOp << ", \"iterations\": " << result.iterations << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    fp << "  ]\n}\n";
+}
+
+int main(int argc, char **argv) {
+    std::string filter, jsonFile;
+    int batches = 9;
+    double minTime = 0.05;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        } else if (arg == "--batches" && i + 1 < argc) {
+            batches = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minTime = std::stod(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter <substring>] [--json <file>] [--batches <n>] [--min-time <seconds>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    std::cout << std::left << std::setw(24) << "benchmark" << std::right << std::setw(16) << "ns/op"
+              << std::setw(22) << "throughput" << std::setw(14) << "allocs/op" << std::endl;
+
+    for (const auto &bench : makeBenchmarks()) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        Result result = measure(bench, batches, minTime);
+        results.emplace_back(result);
+
+        std::ostringstream throughput;
+        throughput << std::fixed << std::setprecision(2) << result.unitsPerSec / 1e6 << " M" << result.unit << "/s";
+        std::cout << std::left << std::setw(24) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << result.nsPerOp << std::setw(22) << throughput.str() << std::setprecision(2)
+                  << std::setw(14) << result.allocsPerOp << std::endl;
+    }
+
+    if (!jsonFile.empty()) {
+        writeJson(jsonFile, results);
+    }
+    return 0;
+}
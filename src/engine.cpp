@@ -0,0 +1,7 @@
+// Implementations of the single-header libraries the engine headers use. Everything else in the engine is header
+// only; this is the one translation unit that gives CompSciEngine its object code.
+
+#define STB_IMAGE_IMPLEMENTATION
+
+#include <stb/stb_image.h>
+#include <stb/stb_vorbis.c>
@@ -0,0 +1,86 @@
+// KTX 1.1 container layout. Shared between the texcook tool (which writes these) and Texture (which maps and uploads
+// them). See https://registry.khronos.org/KTX/specs/1.0/ktxspec_v1.html
+// The GL enums are spelled out here so texcook doesn't have to pull in GLEW.
+
+#pragma once
+
+#include <cstdint>
+
+constexpr uint8_t ktxIdentifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr uint32_t ktxEndianRef = 0x04030201;
+
+constexpr uint32_t ktxUnsignedByte = 0x1401; // GL_UNSIGNED_BYTE
+constexpr uint32_t ktxUnsignedShort = 0x1403; // GL_UNSIGNED_SHORT
+constexpr uint32_t ktxFloat = 0x1406; // GL_FLOAT
+constexpr uint32_t ktxHalfFloat = 0x140B; // GL_HALF_FLOAT
+constexpr uint32_t ktxRed = 0x1903; // GL_RED
+constexpr uint32_t ktxRGB = 0x1907; // GL_RGB
+constexpr uint32_t ktxRGBA = 0x1908; // GL_RGBA
+constexpr uint32_t ktxLuminance = 0x1909; // GL_LUMINANCE
+constexpr uint32_t ktxLuminanceAlpha = 0x190A; // GL_LUMINANCE_ALPHA
+constexpr uint32_t ktxRG = 0x8227; // GL_RG
+constexpr uint32_t ktxRGBA8 = 0x8058; // GL_RGBA8
+constexpr uint32_t ktxDXT1 = 0x83F0; // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+constexpr uint32_t ktxDXT5 = 0x83F3; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+constexpr uint32_t ktxETC2 = 0x9274; // GL_COMPRESSED_RGB8_ETC2
+constexpr uint32_t ktxETC2EAC = 0x9278; // GL_COMPRESSED_RGBA8_ETC2_EAC
+
+struct KtxHeader {
+    uint8_t identifier[12];
+    uint32_t endianness;
+    uint32_t glType; // 0 for compressed formats
+    uint32_t glTypeSize;
+    uint32_t glFormat; // 0 for compressed formats
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+
+static_assert(sizeof(KtxHeader) == 64, "KTX header must be 64 bytes");
+
+// Every mip level is preceded by a uint32 imageSize and padded to 4 bytes.
+inline uint32_t ktxPad4(uint32_t n) {
+    return (n + 3u) & ~3u;
+}
+
+// Bytes GL will read for one w x h level of this header's format (with the 4 byte row alignment KTX uses), or 0 if
+// the format/type combination isn't one we know how to size.
+inline uint64_t ktxLevelSize(const KtxHeader &header, uint32_t w, uint32_t h) {
+    uint64_t blocks = static_cast<uint64_t>((w + 3) / 4) * ((h + 3) / 4);
+    switch (header.glInternalFormat) {
+        case ktxDXT1:
+        case ktxETC2:
+            return blocks * 8;
+        case ktxDXT5:
+        case ktxETC2EAC:
+            return blocks * 16;
+        default:
+            break;
+    }
+
+    uint64_t components;
+    switch (header.glFormat) {
+        case ktxRed: case ktxLuminance: components = 1; break;
+        case ktxRG: case ktxLuminanceAlpha: components = 2; break;
+        case ktxRGB: components = 3; break;
+        case ktxRGBA: components = 4; break;
+        default: return 0;
+    }
+
+    uint64_t typeSize;
+    switch (header.glType) {
+        case ktxUnsignedByte: typeSize = 1; break;
+        case ktxUnsignedShort: case ktxHalfFloat: typeSize = 2; break;
+        case ktxFloat: typeSize = 4; break;
+        default: return 0;
+    }
+
+    uint64_t rowBytes = (w * components * typeSize + 3) & ~3ull;
+    return rowBytes * h;
+}
@@ -6,64 +6,68 @@
 #include "imgui/imgui.h"
 #include "imgui/examples/imgui_impl_glfw.h"
 #include "imgui/examples/imgui_impl_opengl2.h"
+#include "imgui/examples/imgui_impl_opengl3.h"
 
 #include <iostream>
 #include <unordered_map>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <GLFW/glfw3.h>
-#include <random>
-
-#define TINYOBJLOADER_IMPLEMENTATION
-
-#include <tinyobjloader/tiny_obj_loader.h>
-
-#define GLM_ENABLE_EXPERIMENTAL
-
-#include <glm/gtx/hash.hpp>
 
 #include <al.h>
 #include <alc.h>
 
 #include <abstract.cpp>
+#include <audio.h>
+#include <scene.h>
+#include <mesh.h>
+#include <renderqueue.h>
 
 GLFWwindow *win{};
 
-struct Vertex {
-    glm::vec3 pos;
-    glm::vec2 uv;
 
-    bool operator==(const Vertex &rhs) const {
-        return pos == rhs.pos && uv == rhs.uv;
-    }
-};
-
-namespace std {
-    template<>
-    struct hash<Vertex> {
-        size_t operator()(Vertex const &vertex) const {
-            return hash<glm::vec3>()(vertex.pos) ^ hash<glm::vec2>()(vertex.uv);
+int main(int argc, char **argv) {
+    // --gl21 forces the legacy backend. Otherwise try a 4.5 core context and fall back if the driver refuses.
+    // --capture <file> records GL calls so the first frame (and any frame F12 is pressed on) can be replayed.
+    // --prepass starts with the depth pre-pass on; it can also be toggled from the UI.
+    bool wantCore = true;
+    bool depthPrepass = false;
+    std::string captureFile;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--gl21") {
+            wantCore = false;
+        } else if (std::string(argv[i]) == "--prepass") {
+            depthPrepass = true;
+        } else if (std::string(argv[i]) == "--capture" && i + 1 < argc) {
+            captureFile = argv[++i];
         }
-    };
-}
-
+    }
 
-int main() {
     ALCdevice *alDev = alcOpenDevice(nullptr);
     ALCcontext *alCtx = alcCreateContext(alDev, nullptr);
     alcMakeContextCurrent(alCtx);
 
-    alListener3f(AL_VELOCITY, 1, 1, 1);
-
-    std::random_device seeder;
-    std::default_random_engine randEngine(seeder());
-    auto radianDist = std::uniform_real_distribution<float>(0, 2 * 3.14159265);
-
     if (!glfwInit()) {
         throw std::runtime_error("GLFW initialization failed! Aborting!");
     }
 
-    win = glfwCreateWindow(640, 480, "7th Grade Comp Sci Project", nullptr, nullptr);
+    if (wantCore) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+        win = glfwCreateWindow(640, 480, "7th Grade Comp Sci Project", nullptr, nullptr);
+        if (win) {
+            glBackend = GLBackend::Core45;
+        } else {
+            std::cerr << "OpenGL 4.5 core unavailable, falling back to 2.1" << std::endl;
+            glfwDefaultWindowHints();
+        }
+    }
+
+    if (!win) {
+        win = glfwCreateWindow(640, 480, "7th Grade Comp Sci Project", nullptr, nullptr);
+    }
     if (!win) { throw std::runtime_error("Window creation failed! Aborting!"); }
     glfwMakeContextCurrent(win);
     glfwSwapInterval(1);
@@ -72,18 +76,30 @@ int main() {
     if (glewInit() != GLEW_OK) {
         throw std::runtime_error("GLEW initialization failed! Aborting!");
     }
+    flushErrors("glewInit"); // glewInit trips GL_INVALID_ENUM on core contexts
 
     const GLubyte *renderer = glGetString(GL_RENDERER);
     const GLubyte *version = glGetString(GL_VERSION);
-    std::cout << "Initialized OpenGL " << version << " with renderer " << renderer << std::endl;
+    std::cout << "Initialized OpenGL " << version << " with renderer " << renderer << " ("
+              << (glBackend == GLBackend::Core45 ? "4.5 core" : "2.1 legacy") << " backend)" << std::endl;
+
+    // Must be installed before any resources are created so the trace can recreate them
+    std::unique_ptr<GLTrace> trace;
+    if (!captureFile.empty()) {
+        trace = std::make_unique<GLTrace>(captureFile, static_cast<uint8_t>(glBackend));
+        trace->arm();
+        glTrace = trace.get();
+    }
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    std::string shaderDir = glBackend == GLBackend::Core45 ? "./shaders/core/" : "./shaders/";
 
-    glEnable(GL_CULL_FACE);
+    setCapability(GL_DEPTH_TEST, true);
+    setDepthFunc(GL_LESS);
 
-    auto vertShader = Shader("./shaders/default.vert", true);
-    auto fragShader = Shader("./shaders/default.frag", false);
+    setCapability(GL_CULL_FACE, true);
+
+    auto vertShader = Shader(shaderDir + "default.vert", true);
+    auto fragShader = Shader(shaderDir + "default.frag", false);
 
     ShaderProgram shaders;
     shaders.bindAttribLoc(0, "pos");
@@ -93,55 +109,31 @@ int main() {
     shaders.link();
     shaders.bind();
 
+    // Depth-only program for the pre-pass. Same vertex transform as the default program, no fragment work.
+    auto depthVert = Shader(shaderDir + "depth.vert", true);
+    auto depthFrag = Shader(shaderDir + "depth.frag", false);
+
+    ShaderProgram depthShaders;
+    depthShaders.bindAttribLoc(0, "pos");
+    depthShaders.attach(depthVert);
+    depthShaders.attach(depthFrag);
+    depthShaders.link();
+    UniformLocation depthMatM = depthShaders.getLocation("model");
+    UniformLocation depthMatV = depthShaders.getLocation("view");
+    UniformLocation depthMatP = depthShaders.getLocation("projection");
+    shaders.bind();
+
     std::vector<Vertex> modelVboDat;
     std::vector<unsigned> modelIboDat;
-    std::unordered_map<Vertex, unsigned> modelVertMap;
-
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "./res/obj/rick.obj")) {
-        throw std::runtime_error(warn + err);
-    }
-
-    for (const auto &shape : shapes) {
-        for (const auto &index : shape.mesh.indices) {
-            Vertex vertex{};
-            vertex.uv.x = attrib.texcoords[2 * index.texcoord_index + 0];
-            vertex.uv.y = 1.0f - attrib.texcoords[2 * index.texcoord_index + 1];
-
-            vertex.pos.x = attrib.vertices[3 * index.vertex_index + 0];
-            vertex.pos.y = attrib.vertices[3 * index.vertex_index + 1];
-            vertex.pos.z = attrib.vertices[3 * index.vertex_index + 2];
+    loadObj("./res/obj/rick.obj", modelVboDat, modelIboDat);
 
-            auto iter = std::find(modelVboDat.begin(), modelVboDat.end(), vertex);
-
-            if (iter == modelVboDat.end()) {
-                modelVboDat.emplace_back(vertex);
-                modelVertMap[vertex] = modelVboDat.size() - 1;
-                modelIboDat.emplace_back(modelVboDat.size() - 1);
-            } else {
-                modelIboDat.emplace_back(modelVertMap[vertex]);
-            }
-        }
-    }
-
-
-    // TODO: Location to play sound: {-64, 8, -64}
     auto modelVbo = GenericBuffer<Vertex, GL_ARRAY_BUFFER>(modelVboDat);
     auto modelIbo = IBO(modelIboDat);
     auto modelTex = Texture("./res/tex/rick.jpg", true);
     auto modelVao = VAO();
-
-    modelVbo.bind();
-    modelIbo.bind();
-    modelTex.bind();
-    modelVao.bind();
     modelVao.pushFloat(3);
     modelVao.pushFloat(2);
-    modelVao.finalize();
+    modelVao.attach(modelVbo, modelIbo);
 
 
     auto vboDat = std::vector<float>({
@@ -189,16 +181,10 @@ int main() {
     auto vao = VAO();
     vao.pushFloat(3); // Vertex pos
     vao.pushFloat(2); // Texture coords (UV)
+    vao.attach(vbo, ibo);
 
     auto tex = Texture("./res/tex/grass_texture.png");
 
-    tex.bind();
-    vbo.bind();
-    ibo.bind();
-    vao.bind();
-    vao.finalize();
-
-    vao.bind();
     auto postVboDat = std::vector<float>({-1.0f, 1.0f, 0.0f, 1.0f,
                                           -1.0f, -1.0f, 0.0f, 0.0f,
                                           1.0f, -1.0f, 1.0f, 0.0f,
@@ -209,15 +195,12 @@ int main() {
     auto postVbo = VBO(postVboDat);
 
     VAO postVao;
-    postIbo.bind();
-    postVbo.bind();
-    postVao.bind();
     postVao.pushFloat(2);
     postVao.pushFloat(2);
-    postVao.finalize();
+    postVao.attach(postVbo, postIbo);
 
-    Shader postVert = Shader("./shaders/post.vert", true);
-    Shader postFrag = Shader("./shaders/post.frag", false);
+    Shader postVert = Shader(shaderDir + "post.vert", true);
+    Shader postFrag = Shader(shaderDir + "post.frag", false);
     ShaderProgram postShaders;
     postShaders.bindAttribLoc(0, "pos");
     postShaders.bindAttribLoc(1, "inTexCoord");
@@ -232,8 +215,6 @@ int main() {
     ShaderProgram::setFv(kernel, kernelArr, 9);
 
     shaders.bind();
-    shaders.bindAttribLoc(0, "pos");
-    shaders.bindAttribLoc(1, "inTexCoord");
     UniformLocation texSlot = shaders.getLocation("texSlot");
     UniformLocation matM = shaders.getLocation("model");
     UniformLocation matV = shaders.getLocation("view");
@@ -260,7 +241,17 @@ int main() {
 
     // Setup Platform/Renderer bindings
     ImGui_ImplGlfw_InitForOpenGL(win, true);
-    ImGui_ImplOpenGL2_Init();
+    if (glBackend == GLBackend::Core45) {
+        ImGui_ImplOpenGL3_Init("#version 450 core");
+    } else {
+        ImGui_ImplOpenGL2_Init();
+    }
+
+    // view/projection live in a uniform block on the core backend and plain uniforms on the legacy one
+    std::unique_ptr<UniformBuffer<CameraBlock>> cameraUbo;
+    if (glBackend == GLBackend::Core45) {
+        cameraUbo = std::make_unique<UniformBuffer<CameraBlock>>(0);
+    }
 
     float fov = 70;
 
@@ -270,37 +261,75 @@ int main() {
     float modelYaw = 0;
     float modelSpinSpeed = 0.0625;
 
-    ALSrc rickSrc;
-    ALBuf nevaGonna = ALBuf("./res/rick.ogg");
-    rickSrc.bind(&nevaGonna);
-    rickSrc.play();
-
-    auto modelMats = std::vector<glm::mat4>();
-    for (int i = 0; i < 4096; i++) {
-        auto newMat = glm::eulerAngleYXZ(radianDist(randEngine), radianDist(randEngine), radianDist(randEngine));
-        newMat = glm::translate(glm::mat4(1.0f),
-                                glm::vec3((i % 16) * 8 - 64, ((i % 256) / 16) * 8 - 64, (i / 256) * 8 - 64)) * newMat;
-        modelMats.emplace_back(newMat);
+    AABB modelBounds = {modelVboDat[0].pos, modelVboDat[0].pos};
+    for (const auto &vertex : modelVboDat) {
+        modelBounds.min = glm::min(modelBounds.min, vertex.pos);
+        modelBounds.max = glm::max(modelBounds.max, vertex.pos);
     }
 
+    SceneGraph scene;
+    int cubeMesh = scene.addMesh("cube", {{-1, -1, -1}, {1, 1, 1}});
+    int rickMesh = scene.addMesh("rick", modelBounds);
+    scene.load("./res/scenes/default.scene");
+    scene.update();
+
+    NodeHandle rickNode = scene.find("rick");
+    glm::mat4 rickBase = scene.getLocal(rickNode);
+    glm::vec3 modelPos = glm::vec3(scene.getWorld(rickNode)[3]);
+    std::vector<std::pair<int, const glm::mat4 *>> visible;
+
+    // Program ids used in the render queue keys. Materials are the mesh ids, since each mesh has its own texture.
+    // Both materials share the textured fragment shader, so the pre-pass (when on) applies to all of them.
+    constexpr unsigned defaultProgram = 0;
+    constexpr unsigned depthProgram = 1;
+    RenderQueue queue;
+
+    bool captureKeyHeld = false;
+
+    auto bindMesh = [&](int meshId) {
+        if (meshId == rickMesh) {
+            modelTex.bind();
+            modelVbo.bind();
+            modelVao.bind();
+        } else {
+            tex.bind();
+            vbo.bind();
+            vao.bind();
+        }
+    };
+
+    ALBuf nevaGonna = ALBuf("./res/rick.ogg");
+    VoiceManager audio(alDev);
+
+    EmitterHandle rickEmitter = audio.createEmitter(&nevaGonna, modelPos, true, 2);
+    audio.setDistances(rickEmitter, 4, 128);
+    audio.play(rickEmitter);
+
+    EmitterHandle cornerEmitter = audio.createEmitter(&nevaGonna, {-64, 8, -64});
+    audio.setDistances(cornerEmitter, 4, 96);
+    audio.play(cornerEmitter);
+
     while (!glfwWindowShouldClose(win)) {
+        if (glTrace) {
+            glTrace->beginFrame();
+        }
+
         // Start the Dear ImGui frame
-        ImGui_ImplOpenGL2_NewFrame();
+        if (glBackend == GLBackend::Core45) {
+            ImGui_ImplOpenGL3_NewFrame();
+        } else {
+            ImGui_ImplOpenGL2_NewFrame();
+        }
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
         shaders.bind();
-        shaders.bindAttribLoc(0, "pos");
-        shaders.bindAttribLoc(1, "inTexCoord");
         int width, height;
         glfwGetFramebufferSize(win, &width, &height);
         cam.setProj(fov, static_cast<float>(width) / static_cast<float>(height));
         cam.updateViewMat();
 
-        float ori[6] = {cam.forward.x, cam.forward.y, cam.forward.z,
-                        cam.up.x, cam.up.y, cam.up.z};
-        alListener3f(AL_POSITION, cam.pos.x, cam.pos.y, cam.pos.z);
-        alListenerfv(AL_ORIENTATION, ori);
+        audio.update(cam, ImGui::GetIO().DeltaTime);
 
         ALCenum error;
 
@@ -315,38 +344,79 @@ int main() {
             postFramebuf = std::move(newFramebuf);
         }
 
-        glViewport(0, 0, width, height);
+        if (glTrace) {
+            glTrace->marker("scene");
+        }
+        setViewport(0, 0, width, height);
 
-        glEnable(GL_DEPTH_TEST);
+        setCapability(GL_DEPTH_TEST, true);
         postFramebuf.bind();
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        ShaderProgram::setMat4(matV, cam.getView());
-        ShaderProgram::setMat4(matP, cam.getProj());
-
-
-        tex.bind();
-        vbo.bind();
-        vao.bind();
-        for (int i = 0; i<4096; i++) {
-            ShaderProgram::setMat4(matM, modelMats[i]);
-            ibo.draw(4096);
+        clearFramebuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glm::mat4 view = cam.getView();
+        if (cameraUbo) {
+            cameraUbo->set({view, cam.getProj()});
+        } else {
+            ShaderProgram::setMat4(matV, view);
+            ShaderProgram::setMat4(matP, cam.getProj());
+            if (depthPrepass) {
+                depthShaders.bind();
+                ShaderProgram::setMat4(depthMatV, view);
+                ShaderProgram::setMat4(depthMatP, cam.getProj());
+            }
         }
 
-        ShaderProgram::setMat4(matM, glm::mat4(1.0f));
 
         modelYaw += modelSpinSpeed;
-        ShaderProgram::setMat4(matM,
-                               glm::translate(glm::mat4(1.0f), {4, 1, 0}) *
-                               glm::scale(glm::mat4(1.0f), glm::vec3({1, 1, 1}) * 0.1f)
-                               * glm::eulerAngleYXZ(modelYaw, 0.0f, 0.0f)
-        );
-        modelTex.bind();
-
-        modelVbo.bind();
-        modelVao.bind();
-        modelIbo.draw(1);
+        scene.setLocal(rickNode, rickBase * glm::eulerAngleYXZ(modelYaw, 0.0f, 0.0f));
+        scene.update();
+
+        visible.clear();
+        scene.collectVisible(cam.getProj() * view, visible);
+
+        // Sort front to back by the view space depth of each node's origin
+        queue.clear();
+        for (const auto &[meshId, model] : visible) {
+            float viewDepth = -(view * (*model)[3]).z;
+            if (depthPrepass) {
+                queue.submit(RenderPass::DepthPrepass, depthProgram, meshId, viewDepth, meshId, model);
+            }
+            queue.submit(RenderPass::Opaque, defaultProgram, meshId, viewDepth, meshId, model);
+        }
+        queue.sort();
+
+        int boundMesh = -1;
+        unsigned boundProgram = ~0u;
+        for (const auto &item : queue.getItems()) {
+            unsigned program = RenderQueue::programOf(item.key);
+            if (program != boundProgram) {
+                if (program == depthProgram) {
+                    setColorMask(false);
+                    depthShaders.bind();
+                } else {
+                    // Depth is already laid down by the pre-pass, so only the visible surface passes and there is
+                    // nothing left to write
+                    setColorMask(true);
+                    if (depthPrepass) {
+                        setDepthFunc(GL_LEQUAL);
+                        setDepthMask(false);
+                    }
+                    shaders.bind();
+                }
+                boundProgram = program;
+            }
+            if (item.mesh != boundMesh) {
+                bindMesh(item.mesh);
+                boundMesh = item.mesh;
+            }
+            ShaderProgram::setMat4(program == depthProgram ? depthMatM : matM, *item.model);
+            (item.mesh == cubeMesh ? ibo : modelIbo).draw();
+        }
+        if (depthPrepass) {
+            setDepthMask(true);
+            setDepthFunc(GL_LESS);
+        }
 
 
         ImGui::Begin("Stuff");
@@ -355,6 +425,10 @@ int main() {
         ImGui::Text("Euler Angle: [%f, %f, %f]", cam.euler.x, cam.euler.y, cam.euler.z);
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate,
                     ImGui::GetIO().Framerate);
+        ImGui::Text("Drawn: %zu/%zu nodes (%zu draws)", visible.size(), scene.size(), queue.size());
+        ImGui::Checkbox("Depth pre-pass", &depthPrepass);
+        ImGui::Text("Voices: %d/%d, emitters: %zu", audio.getActiveVoices(), audio.getVoiceCount(),
+                    audio.getEmitterCount());
         for (int i = 0; i < 9; i++) {
             std::string name = "Kernel ";
             name += std::to_string(i);
@@ -362,32 +436,48 @@ int main() {
         }
         ImGui::End();
 
-        glDisable(GL_DEPTH_TEST);
+        if (glTrace) {
+            glTrace->marker("post");
+        }
+        setCapability(GL_DEPTH_TEST, false);
         Framebuffer::bindDefault();
         ImGui::Render();
-        glClear(GL_COLOR_BUFFER_BIT);
+        clearFramebuffer(GL_COLOR_BUFFER_BIT);
 
         postShaders.bind();
-        postShaders.bindAttribLoc(0, "pos");
-        postShaders.bindAttribLoc(1, "inTexCoord");
         ShaderProgram::setFv(kernel, &kernelArr[0], 9);
         postFramebuf.bindTex();
         postVbo.bind();
         postVao.bind();
         postIbo.draw();
 
+        if (glTrace) {
+            glTrace->endFrame();
+        }
+
         glUseProgram(0);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, 0);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        ImGui_ImplOpenGL2_RenderDrawData(ImGui::GetDrawData());
+        if (glBackend == GLBackend::Core45) {
+            glBindVertexArray(0);
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        } else {
+            ImGui_ImplOpenGL2_RenderDrawData(ImGui::GetDrawData());
+        }
 
         glfwSwapBuffers(win);
         glfwPollEvents();
         flushErrors("null");
 
+        // Only on the press edge; holding F12 would otherwise rewrite the whole trace every frame
+        bool captureKey = glfwGetKey(win, GLFW_KEY_F12) == GLFW_PRESS;
+        if (glTrace && captureKey && !captureKeyHeld) {
+            glTrace->arm();
+        }
+        captureKeyHeld = captureKey;
         if (glfwGetKey(win, GLFW_KEY_UP) == GLFW_PRESS) {
             cam.euler.x -= mouseSense;
         }
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only mmap of a whole file. Lets loaders hand pages straight to GL without an intermediate copy.
+class MappedFile {
+private:
+    int fd = -1;
+    void *ptr = nullptr;
+    size_t len{};
+
+public:
+    explicit MappedFile(const std::string &filename) {
+        fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open " + filename);
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Failed to stat " + filename);
+        }
+        len = st.st_size;
+
+        if (len > 0) {
+            ptr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Failed to map " + filename);
+            }
+        }
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] inline const unsigned char *data() const {
+        return static_cast<const unsigned char *>(ptr);
+    }
+
+    [[nodiscard]] inline size_t size() const {
+        return len;
+    }
+
+    ~MappedFile() {
+        if (ptr && ptr != MAP_FAILED) {
+            munmap(ptr, len);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
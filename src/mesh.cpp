@@ -0,0 +1,305 @@
+// OBJ import. The file is memory mapped and cut into line aligned chunks that are parsed on separate threads. A chunk
+// only knows how many records it has seen itself, so relative indices are kept relative to the chunk and resolved
+// when the chunks are merged in file order.
+
+#include "mesh.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "mappedfile.h"
+
+namespace {
+    // Chunks smaller than this aren't worth a thread
+    constexpr size_t minChunkSize = 256 * 1024;
+
+    // Corner flags
+    constexpr unsigned char posRelative = 1; // pos is relative to the chunk's first position
+    constexpr unsigned char uvRelative = 2;
+    constexpr unsigned char noUv = 4; // face didn't give a texcoord
+
+    struct Corner {
+        int pos;
+        int uv;
+        unsigned char flags;
+    };
+
+    // A shape (o/g) or material (usemtl) switch that takes effect from corners[corner] on.
+    struct Group {
+        size_t corner;
+        bool isMaterial;
+        std::string name;
+    };
+
+    struct Chunk {
+        const char *begin;
+        const char *end;
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texcoords;
+        std::vector<Corner> corners; // already triangulated, three per triangle
+        std::vector<Group> groups;
+
+        std::exception_ptr error;
+    };
+
+    inline const char *skipSpace(const char *ptr, const char *end) {
+        while (ptr < end && (*ptr == ' ' || *ptr == '\t')) {
+            ptr++;
+        }
+        return ptr;
+    }
+
+    inline bool parseFloat(const char *&ptr, const char *end, float &val) {
+        ptr = skipSpace(ptr, end);
+        if (ptr < end && *ptr == '+') {
+            ptr++;
+        }
+        auto result = std::from_chars(ptr, end, val);
+        ptr = result.ptr;
+        return result.ec == std::errc();
+    }
+
+    inline bool parseInt(const char *&ptr, const char *end, int &val) {
+        auto result = std::from_chars(ptr, end, val);
+        ptr = result.ptr;
+        return result.ec == std::errc();
+    }
+
+    // OBJ indices are 1-based, or negative to count back from the latest record. Zero is invalid.
+    inline bool resolveIndex(int index, size_t localCount, int &out, bool &relative) {
+        if (index > 0) {
+            out = index - 1;
+            relative = false;
+        } else if (index < 0) {
+            out = static_cast<int>(localCount) + index;
+            relative = true;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Parses one "v", "v/vt", "v//vn" or "v/vt/vn" face corner. Normals aren't part of Vertex, so vn is only checked.
+    bool parseCorner(const char *&ptr, const char *end, const Chunk &chunk, Corner &corner) {
+        int index;
+        bool relative;
+        corner.flags = 0;
+
+        if (!parseInt(ptr, end, index) || !resolveIndex(index, chunk.positions.size(), corner.pos, relative)) {
+            return false;
+        }
+        if (relative) {
+            corner.flags |= posRelative;
+        }
+
+        corner.flags |= noUv;
+        if (ptr < end && *ptr == '/') {
+            ptr++;
+            if (ptr < end && *ptr != '/') {
+                if (!parseInt(ptr, end, index) || !resolveIndex(index, chunk.texcoords.size(), corner.uv, relative)) {
+                    return false;
+                }
+                corner.flags = (corner.flags & ~noUv) | (relative ? uvRelative : 0);
+            }
+            if (ptr < end && *ptr == '/') {
+                ptr++;
+                if (!parseInt(ptr, end, index) || index == 0) {
+                    return false;
+                }
+            }
+        }
+        return ptr == end || *ptr == ' ' || *ptr == '\t';
+    }
+
+    void parseChunk(Chunk &chunk, const std::string &file) {
+        std::vector<Corner> polygon;
+
+        const char *ptr = chunk.begin;
+        while (ptr < chunk.end) {
+            const char *eol = static_cast<const char *>(std::memchr(ptr, '\n', chunk.end - ptr));
+            const char *next = eol ? eol + 1 : chunk.end;
+            const char *end = eol ? eol : chunk.end;
+            if (end > ptr && end[-1] == '\r') {
+                end--;
+            }
+
+            const char *line = ptr = skipSpace(ptr, end);
+            const char *keyEnd = ptr;
+            while (keyEnd < end && *keyEnd != ' ' && *keyEnd != '\t') {
+                keyEnd++;
+            }
+            std::string_view key(ptr, keyEnd - ptr);
+            ptr = keyEnd;
+
+            bool ok = true;
+            if (key == "v") {
+                glm::vec3 pos;
+                ok = parseFloat(ptr, end, pos.x) && parseFloat(ptr, end, pos.y) && parseFloat(ptr, end, pos.z);
+                chunk.positions.emplace_back(pos);
+            } else if (key == "vt") {
+                glm::vec2 uv{};
+                ok = parseFloat(ptr, end, uv.x);
+                const char *rest = skipSpace(ptr, end);
+                if (ok && rest < end) {
+                    ok = parseFloat(ptr, end, uv.y);
+                }
+                chunk.texcoords.emplace_back(uv);
+            } else if (key == "f") {
+                polygon.clear();
+                while ((ptr = skipSpace(ptr, end)) < end && ok) {
+                    Corner corner{};
+                    ok = parseCorner(ptr, end, chunk, corner);
+                    polygon.emplace_back(corner);
+                }
+                ok = ok && polygon.size() >= 3;
+
+                // Fan triangulation; fine for the convex polygons exporters write
+                for (size_t i = 2; ok && i < polygon.size(); i++) {
+                    chunk.corners.emplace_back(polygon[0]);
+                    chunk.corners.emplace_back(polygon[i - 1]);
+                    chunk.corners.emplace_back(polygon[i]);
+                }
+            } else if (key == "o" || key == "g" || key == "usemtl") {
+                const char *nameBegin = skipSpace(ptr, end);
+                const char *nameEnd = end;
+                while (nameEnd > nameBegin && (nameEnd[-1] == ' ' || nameEnd[-1] == '\t')) {
+                    nameEnd--;
+                }
+                chunk.groups.push_back({chunk.corners.size(), key == "usemtl", std::string(nameBegin, nameEnd)});
+            }
+            // vn, comments, s, mtllib, l, p and anything else don't affect the Vertex/index layout
+
+            if (!ok) {
+                throw std::runtime_error("Malformed line in " + file + ": " + std::string(line, end));
+            }
+            ptr = next;
+        }
+    }
+
+    // Splits [begin, end) into `count` pieces that each start at the beginning of a line.
+    std::vector<Chunk> splitChunks(const char *begin, const char *end, size_t count) {
+        std::vector<Chunk> chunks;
+        const char *chunkBegin = begin;
+        for (size_t i = 1; i <= count && chunkBegin < end; i++) {
+            const char *chunkEnd = end;
+            if (i < count) {
+                chunkEnd = std::max(chunkBegin, begin + (end - begin) * i / count);
+                const char *eol = static_cast<const char *>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+                chunkEnd = eol ? eol + 1 : end;
+            }
+            chunks.push_back({chunkBegin, chunkEnd, {}, {}, {}, {}, {}});
+            chunkBegin = chunkEnd;
+        }
+        return chunks;
+    }
+}
+
+void loadObj(const std::string &file, std::vector<Vertex> &vertices, std::vector<unsigned> &indices,
+             std::vector<MeshPart> *parts) {
+    MappedFile map(file);
+    const char *begin = reinterpret_cast<const char *>(map.data());
+    const char *end = begin + map.size();
+
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Chunk> chunks = splitChunks(begin, end, std::clamp<size_t>(map.size() / minChunkSize, 1,
+                                                                             threadCount));
+
+    auto parse = [&file](Chunk &chunk) {
+        try {
+            parseChunk(chunk, file);
+        } catch (...) {
+            chunk.error = std::current_exception();
+        }
+    };
+
+    // The calling thread takes the first chunk itself
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        workers.emplace_back(parse, std::ref(chunks[i]));
+    }
+    if (!chunks.empty()) {
+        parse(chunks[0]);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (const auto &chunk : chunks) {
+        if (chunk.error) {
+            std::rethrow_exception(chunk.error);
+        }
+    }
+
+    // Faces may refer to records from any chunk, so gather them in file order first
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texcoords;
+    std::vector<size_t> posBase, uvBase;
+    size_t cornerCount = 0;
+    for (const auto &chunk : chunks) {
+        posBase.emplace_back(positions.size());
+        uvBase.emplace_back(texcoords.size());
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        texcoords.insert(texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+        cornerCount += chunk.corners.size();
+    }
+
+    std::unordered_map<Vertex, unsigned> vertMap;
+    vertMap.reserve(positions.size());
+    indices.reserve(indices.size() + cornerCount);
+
+    std::string shape, material;
+    size_t partStart = indices.size();
+    auto closePart = [&] {
+        if (parts && indices.size() > partStart) {
+            parts->push_back({shape, material, static_cast<unsigned>(partStart),
+                              static_cast<unsigned>(indices.size() - partStart)});
+        }
+        partStart = indices.size();
+    };
+
+    for (size_t c = 0; c < chunks.size(); c++) {
+        const Chunk &chunk = chunks[c];
+        size_t group = 0;
+
+        for (size_t i = 0; i <= chunk.corners.size(); i++) {
+            for (; group < chunk.groups.size() && chunk.groups[group].corner == i; group++) {
+                closePart();
+                (chunk.groups[group].isMaterial ? material : shape) = chunk.groups[group].name;
+            }
+            if (i == chunk.corners.size()) {
+                break;
+            }
+
+            const Corner &corner = chunk.corners[i];
+            long long pos = corner.pos + ((corner.flags & posRelative) ? static_cast<long long>(posBase[c]) : 0);
+            if (pos < 0 || pos >= static_cast<long long>(positions.size())) {
+                throw std::runtime_error("Face refers to a missing vertex in " + file);
+            }
+
+            Vertex vertex{};
+            vertex.pos = positions[pos];
+            if (!(corner.flags & noUv)) {
+                long long uv = corner.uv + ((corner.flags & uvRelative) ? static_cast<long long>(uvBase[c]) : 0);
+                if (uv < 0 || uv >= static_cast<long long>(texcoords.size())) {
+                    throw std::runtime_error("Face refers to a missing texture coordinate in " + file);
+                }
+                vertex.uv.x = texcoords[uv].x;
+                vertex.uv.y = 1.0f - texcoords[uv].y;
+            }
+
+            auto [iter, inserted] = vertMap.try_emplace(vertex, static_cast<unsigned>(vertices.size()));
+            if (inserted) {
+                vertices.emplace_back(vertex);
+            }
+            indices.emplace_back(iter->second);
+        }
+    }
+    closePart();
+}
@@ -0,0 +1,46 @@
+// Mesh import. Turns an OBJ into the interleaved Vertex/index layout the renderer draws.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+struct Vertex {
+    glm::vec3 pos;
+    glm::vec2 uv;
+
+    bool operator==(const Vertex &rhs) const {
+        return pos == rhs.pos && uv == rhs.uv;
+    }
+};
+
+namespace std {
+    template<>
+    struct hash<Vertex> {
+        size_t operator()(Vertex const &vertex) const {
+            return hash<glm::vec3>()(vertex.pos) ^ hash<glm::vec2>()(vertex.uv);
+        }
+    };
+}
+
+/**
+ * A run of indices that share one OBJ shape (`o`/`g`) and material (`usemtl`). Ranges are in `indices` order and
+ * don't overlap.
+ */
+struct MeshPart {
+    std::string shape;
+    std::string material;
+    unsigned firstIndex;
+    unsigned indexCount;
+};
+
+/**
+ * Loads every shape in `file`, deduplicating identical vertices. Appends to `vertices` and `indices`, and to `parts`
+ * if given. Polygons are fan triangulated and negative (relative) indices are resolved. Large files are parsed on
+ * several threads. Throws if the file can't be parsed.
+ */
+void loadObj(const std::string &file, std::vector<Vertex> &vertices, std::vector<unsigned> &indices,
+             std::vector<MeshPart> *parts = nullptr);
@@ -0,0 +1,123 @@
+// Render queue. Every draw of a frame is submitted with a 64-bit sort key and the whole list is radix sorted once,
+// so draws come out grouped by pass, then program, then material, and front to back within a material. Drawing the
+// nearest geometry first lets the depth test reject hidden fragments before they are shaded, which is most of the
+// cost on a software rasterizer.
+//
+// Key layout, most significant first:
+//   [63..60] pass   [59..48] program   [47..32] material   [31..0] view depth
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+enum class RenderPass : uint8_t {
+    DepthPrepass, // depth only, for materials whose fragment shader is expensive enough to be worth drawing twice
+    Opaque,
+};
+
+struct DrawItem {
+    uint64_t key;
+    int mesh;
+    const glm::mat4 *model;
+};
+
+class RenderQueue {
+private:
+    std::vector<DrawItem> items;
+    std::vector<DrawItem> scratch; // radix sort ping-pong buffer, reused across frames
+
+public:
+    /**
+     * Builds a sort key. `program` must fit in 12 bits and `material` in 16. `viewDepth` is the distance along the
+     * view direction; anything behind the camera sorts as 0.
+     */
+    static inline uint64_t makeKey(RenderPass pass, unsigned program, unsigned material, float viewDepth) {
+        // Non-negative IEEE floats compare the same as their bit patterns, which gives a 32-bit quantized depth that
+        // keeps full precision up close where it matters.
+        float depth = std::max(viewDepth, 0.0f);
+        uint32_t depthBits;
+        std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+        return static_cast<uint64_t>(pass) << 60 | static_cast<uint64_t>(program & 0xFFF) << 48 |
+               static_cast<uint64_t>(material & 0xFFFF) << 32 | depthBits;
+    }
+
+    static inline RenderPass passOf(uint64_t key) {
+        return static_cast<RenderPass>(key >> 60);
+    }
+
+    static inline unsigned programOf(uint64_t key) {
+        return (key >> 48) & 0xFFF;
+    }
+
+    static inline unsigned materialOf(uint64_t key) {
+        return (key >> 32) & 0xFFFF;
+    }
+
+    inline void clear() {
+        items.clear();
+    }
+
+    inline void submit(RenderPass pass, unsigned program, unsigned material, float viewDepth, int mesh,
+                       const glm::mat4 *model) {
+        items.push_back({makeKey(pass, program, material, viewDepth), mesh, model});
+    }
+
+    [[nodiscard]] inline const std::vector<DrawItem> &getItems() const {
+        return items;
+    }
+
+    [[nodiscard]] inline size_t size() const {
+        return items.size();
+    }
+
+    /**
+     * Stable LSD radix sort on the keys, one byte per pass. All eight histograms are built in a single read of the
+     * keys, and a byte that is the same for every item (usually the pass, program and material bytes) skips its
+     * scatter entirely.
+     */
+    void sort() {
+        size_t count = items.size();
+        if (count < 2) {
+            return;
+        }
+        scratch.resize(count);
+
+        uint32_t histograms[8][256] = {};
+        for (const auto &item : items) {
+            for (int byte = 0; byte < 8; byte++) {
+                histograms[byte][(item.key >> (byte * 8)) & 0xFF]++;
+            }
+        }
+
+        DrawItem *src = items.data();
+        DrawItem *dst = scratch.data();
+        for (int byte = 0; byte < 8; byte++) {
+            uint32_t *histogram = histograms[byte];
+            unsigned shift = byte * 8;
+            if (histogram[(src[0].key >> shift) & 0xFF] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (int bucket = 0; bucket < 256; bucket++) {
+                uint32_t bucketCount = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketCount;
+            }
+            for (size_t i = 0; i < count; i++) {
+                dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != items.data()) {
+            items.swap(scratch);
+        }
+    }
+};
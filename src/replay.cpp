@@ -0,0 +1,642 @@
+// Offscreen replay of a trace written by `CompSciProj --capture <file>`. Recreates every resource in the trace once,
+// then re-executes the captured frame in a loop and reports how long each marked range took. Ranges are fenced with
+// glFinish, so the numbers include the driver's work (on llvmpipe, the rasterizer itself), not just submission.
+//
+// Usage: replay <trace> [iterations] [warmup]
+// The context comes from a hidden GLFW window, so a display is still required. On a machine without one, run it
+// under a virtual X server, e.g. `xvfb-run -a replay frame.trace`.
+
+#define GLEW_STATIC
+#define GLFW_INCLUDE_NONE
+
+// abstract.cpp pulls in glm/gtx headers. CompSciEngine defines this for its users; the guard keeps replay.cpp
+// building on its own too.
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#define GLM_ENABLE_EXPERIMENTAL
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <unordered_map>
+
+#include <abstract.cpp>
+
+struct TraceRange {
+    std::string name;
+    unsigned ops{};
+    unsigned draws{};
+    std::vector<double> ms;
+};
+
+class Replayer {
+private:
+    const unsigned char *ptr{};
+    const unsigned char *end{};
+
+    std::unordered_map<uint32_t, GLuint> buffers;
+    std::unordered_map<uint32_t, GLuint> vertexArrays;
+    std::unordered_map<uint32_t, GLuint> shaders;
+    std::unordered_map<uint32_t, GLuint> programs;
+    std::unordered_map<uint32_t, GLuint> textures;
+    std::unordered_map<uint32_t, GLuint> renderbuffers;
+    std::unordered_map<uint32_t, GLuint> framebuffers;
+
+    // Uniform locations aren't stable across drivers, so they're remapped per (traced program, traced location).
+    std::map<std::pair<uint32_t, int32_t>, GLint> locations;
+    uint32_t currentProgram{};
+
+    template<typename T>
+    T get() {
+        if (ptr + sizeof(T) > end) {
+            throw std::runtime_error("Truncated trace");
+        }
+        T val;
+        std::memcpy(&val, ptr, sizeof(T));
+        ptr += sizeof(T);
+        return val;
+    }
+
+    std::pair<const unsigned char *, uint32_t> getBlob() {
+        auto len = get<uint32_t>();
+        if (ptr + len > end) {
+            throw std::runtime_error("Truncated trace");
+        }
+        const unsigned char *data = ptr;
+        ptr += len;
+        return {data, len};
+    }
+
+    std::string getString() {
+        auto [data, len] = getBlob();
+        return std::string(reinterpret_cast<const char *>(data), len);
+    }
+
+    static GLuint lookup(const std::unordered_map<uint32_t, GLuint> &map, uint32_t id) {
+        auto iter = map.find(id);
+        return iter == map.end() ? 0 : iter->second;
+    }
+
+    GLint location(int32_t traced) const {
+        auto iter = locations.find({currentProgram, traced});
+        return iter == locations.end() ? -1 : iter->second;
+    }
+
+    void bindTexture(GLuint tex) const {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, tex);
+    }
+
+    // Mirrors Framebuffer's constructor, including its untraced filter setup: the single level color texture would
+    // otherwise be mipmap incomplete (legacy) or nearest filtered (core) when the post pass samples it.
+    void createFramebuffer(uint32_t id, uint32_t traceTex, uint32_t traceRbo, GLsizei width, GLsizei height) {
+        GLuint fb, tex, rbo;
+        if (glBackend == GLBackend::Core45) {
+            glCreateFramebuffers(1, &fb);
+            glCreateTextures(GL_TEXTURE_2D, 1, &tex);
+            glCreateRenderbuffers(1, &rbo);
+            glNamedRenderbufferStorage(rbo, GL_DEPTH24_STENCIL8, width, height);
+            glNamedFramebufferRenderbuffer(fb, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+            glTextureStorage2D(tex, 1, GL_RGB8, width, height);
+            glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glNamedFramebufferTexture(fb, GL_COLOR_ATTACHMENT0, tex, 0);
+        } else {
+            glGenFramebuffers(1, &fb);
+            glGenTextures(1, &tex);
+            glGenRenderbuffers(1, &rbo);
+            glBindFramebuffer(GL_FRAMEBUFFER, fb);
+            glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+            bindTexture(tex);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+        }
+
+        framebuffers[id] = fb;
+        textures[traceTex] = tex;
+        renderbuffers[traceRbo] = rbo;
+    }
+
+    void texImage() {
+        auto id = get<uint32_t>();
+        auto level = get<int32_t>();
+        auto internalFormat = get<uint32_t>();
+        auto width = get<int32_t>();
+        auto height = get<int32_t>();
+        auto format = get<uint32_t>();
+        auto type = get<uint32_t>();
+        auto flags = get<uint8_t>();
+        auto alignment = get<int32_t>();
+        auto [pixels, len] = getBlob();
+
+        GLuint tex = lookup(textures, id);
+        bool compressed = flags & traceTexCompressed;
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+        if (flags & traceTexSubImage) {
+            if (compressed) {
+                glCompressedTextureSubImage2D(tex, level, 0, 0, width, height, internalFormat, len, pixels);
+            } else {
+                glTextureSubImage2D(tex, level, 0, 0, width, height, format, type, pixels);
+            }
+        } else {
+            bindTexture(tex);
+            if (compressed) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, len, pixels);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, type, pixels);
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+public:
+    Replayer(const unsigned char *begin, const unsigned char *end) : ptr(begin), end(end) {}
+
+    [[nodiscard]] inline const unsigned char *tell() const {
+        return ptr;
+    }
+
+    inline void seek(const unsigned char *pos) {
+        ptr = pos;
+    }
+
+    /**
+     * Decodes one op. Executes it unless `execute` is false, in which case its payload is only skipped.
+     * Markers are returned to the caller with their name in `marker`.
+     */
+    TraceOp step(bool execute, std::string &marker) {
+        auto op = get<TraceOp>();
+        bool core = glBackend == GLBackend::Core45;
+
+        switch (op) {
+            case TraceOp::FrameBegin:
+            case TraceOp::FrameEnd:
+                break;
+            case TraceOp::Marker:
+                marker = getString();
+                break;
+
+            case TraceOp::CreateBuffer: {
+                auto id = get<uint32_t>();
+                auto target = get<uint32_t>();
+                auto [data, len] = getBlob();
+                if (!execute) break;
+                GLuint buf;
+                if (core) {
+                    glCreateBuffers(1, &buf);
+                    glNamedBufferStorage(buf, len, data, 0);
+                } else {
+                    glGenBuffers(1, &buf);
+                    glBindBuffer(target, buf);
+                    glBufferData(target, len, data, GL_STATIC_DRAW);
+                }
+                buffers[id] = buf;
+                break;
+            }
+            case TraceOp::BindBuffer: {
+                auto target = get<uint32_t>();
+                auto id = get<uint32_t>();
+                if (execute) glBindBuffer(target, lookup(buffers, id));
+                break;
+            }
+            case TraceOp::CreateUniformBuffer: {
+                auto id = get<uint32_t>();
+                auto binding = get<uint32_t>();
+                auto size = get<uint32_t>();
+                if (!execute) break;
+                GLuint buf;
+                glCreateBuffers(1, &buf);
+                glNamedBufferStorage(buf, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+                glBindBufferBase(GL_UNIFORM_BUFFER, binding, buf);
+                buffers[id] = buf;
+                break;
+            }
+            case TraceOp::UniformBufferData: {
+                auto id = get<uint32_t>();
+                auto [data, len] = getBlob();
+                if (execute) glNamedBufferSubData(lookup(buffers, id), 0, len, data);
+                break;
+            }
+
+            case TraceOp::CreateVertexArray: {
+                auto id = get<uint32_t>();
+                if (!execute) break;
+                GLuint vao;
+                glCreateVertexArrays(1, &vao);
+                vertexArrays[id] = vao;
+                break;
+            }
+            case TraceOp::BindVertexArray: {
+                auto id = get<uint32_t>();
+                if (execute) glBindVertexArray(lookup(vertexArrays, id));
+                break;
+            }
+            case TraceOp::AttribPointers: {
+                auto stride = get<uint32_t>();
+                auto count = get<uint32_t>();
+                for (uint32_t i = 0; i < count; i++) {
+                    auto index = get<uint32_t>();
+                    auto size = get<uint32_t>();
+                    auto offset = get<uint32_t>();
+                    if (!execute) continue;
+                    glEnableVertexAttribArray(index);
+                    glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride,
+                                          reinterpret_cast<void *>(static_cast<uintptr_t>(offset)));
+                }
+                break;
+            }
+
+            case TraceOp::VertexArrayLayout: {
+                auto vao = get<uint32_t>();
+                auto vbo = get<uint32_t>();
+                auto ibo = get<uint32_t>();
+                auto stride = get<uint32_t>();
+                auto count = get<uint32_t>();
+                GLuint vertexArray = execute ? lookup(vertexArrays, vao) : 0;
+                if (execute) glVertexArrayVertexBuffer(vertexArray, 0, lookup(buffers, vbo), 0, stride);
+                for (uint32_t i = 0; i < count; i++) {
+                    auto index = get<uint32_t>();
+                    auto size = get<uint32_t>();
+                    auto offset = get<uint32_t>();
+                    if (!execute) continue;
+                    glEnableVertexArrayAttrib(vertexArray, index);
+                    glVertexArrayAttribFormat(vertexArray, index, size, GL_FLOAT, GL_FALSE, offset);
+                    glVertexArrayAttribBinding(vertexArray, index, 0);
+                }
+                if (execute) glVertexArrayElementBuffer(vertexArray, lookup(buffers, ibo));
+                break;
+            }
+
+            case TraceOp::ShaderSource: {
+                auto id = get<uint32_t>();
+                auto isVert = get<uint8_t>();
+                std::string source = getString();
+                if (!execute) break;
+                GLuint shader = glCreateShader(isVert ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER);
+                const char *src = source.c_str();
+                glShaderSource(shader, 1, &src, nullptr);
+                glCompileShader(shader);
+                GLint success;
+                glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+                if (!success) {
+                    char infoLog[512];
+                    glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+                    throw std::runtime_error("Failed to compile traced shader: " + std::string(infoLog));
+                }
+                shaders[id] = shader;
+                break;
+            }
+            case TraceOp::CreateProgram: {
+                auto id = get<uint32_t>();
+                if (execute) programs[id] = glCreateProgram();
+                break;
+            }
+            case TraceOp::AttachShader: {
+                auto program = get<uint32_t>();
+                auto shader = get<uint32_t>();
+                if (execute) glAttachShader(lookup(programs, program), lookup(shaders, shader));
+                break;
+            }
+            case TraceOp::BindAttribLocation: {
+                auto program = get<uint32_t>();
+                auto index = get<uint32_t>();
+                std::string name = getString();
+                if (execute) glBindAttribLocation(lookup(programs, program), index, name.c_str());
+                break;
+            }
+            case TraceOp::LinkProgram: {
+                auto program = get<uint32_t>();
+                if (execute) glLinkProgram(lookup(programs, program));
+                break;
+            }
+            case TraceOp::UseProgram: {
+                auto program = get<uint32_t>();
+                if (!execute) break;
+                currentProgram = program;
+                glUseProgram(lookup(programs, program));
+                break;
+            }
+            case TraceOp::UniformLocation: {
+                auto program = get<uint32_t>();
+                std::string name = getString();
+                auto loc = get<int32_t>();
+                if (execute) locations[{program, loc}] = glGetUniformLocation(lookup(programs, program), name.c_str());
+                break;
+            }
+            case TraceOp::UniformMat4: {
+                auto loc = get<int32_t>();
+                float vals[16];
+                for (float &val : vals) {
+                    val = get<float>();
+                }
+                if (execute) glUniformMatrix4fv(location(loc), 1, GL_FALSE, vals);
+                break;
+            }
+            case TraceOp::Uniform1fv: {
+                auto loc = get<int32_t>();
+                auto count = get<uint32_t>();
+                std::vector<float> vals(count);
+                for (float &val : vals) {
+                    val = get<float>();
+                }
+                if (execute) glUniform1fv(location(loc), count, vals.data());
+                break;
+            }
+            case TraceOp::Uniform1i: {
+                auto loc = get<int32_t>();
+                auto val = get<int32_t>();
+                if (execute) glUniform1i(location(loc), val);
+                break;
+            }
+
+            case TraceOp::CreateTexture: {
+                auto id = get<uint32_t>();
+                if (!execute) break;
+                GLuint tex;
+                if (core) {
+                    glCreateTextures(GL_TEXTURE_2D, 1, &tex);
+                } else {
+                    glGenTextures(1, &tex);
+                }
+                textures[id] = tex;
+                break;
+            }
+            case TraceOp::BindTexture: {
+                auto id = get<uint32_t>();
+                if (!execute) break;
+                if (core) {
+                    glBindTextureUnit(0, lookup(textures, id));
+                } else {
+                    bindTexture(lookup(textures, id));
+                }
+                break;
+            }
+            case TraceOp::TexParam: {
+                auto id = get<uint32_t>();
+                auto pname = get<uint32_t>();
+                auto val = get<int32_t>();
+                if (!execute) break;
+                if (core) {
+                    glTextureParameteri(lookup(textures, id), pname, val);
+                } else {
+                    bindTexture(lookup(textures, id));
+                    glTexParameteri(GL_TEXTURE_2D, pname, val);
+                }
+                break;
+            }
+            case TraceOp::TexStorage: {
+                auto id = get<uint32_t>();
+                auto levels = get<int32_t>();
+                auto internalFormat = get<uint32_t>();
+                auto width = get<int32_t>();
+                auto height = get<int32_t>();
+                if (execute) glTextureStorage2D(lookup(textures, id), levels, internalFormat, width, height);
+                break;
+            }
+            case TraceOp::TexImage: {
+                if (execute) {
+                    texImage();
+                } else {
+                    ptr += 4 * 8 + 1; // id .. alignment
+                    getBlob();
+                }
+                break;
+            }
+            case TraceOp::GenerateMipmap: {
+                auto id = get<uint32_t>();
+                if (!execute) break;
+                if (core) {
+                    glGenerateTextureMipmap(lookup(textures, id));
+                } else {
+                    bindTexture(lookup(textures, id));
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                }
+                break;
+            }
+
+            case TraceOp::CreateFramebuffer: {
+                auto id = get<uint32_t>();
+                auto tex = get<uint32_t>();
+                auto rbo = get<uint32_t>();
+                auto width = get<int32_t>();
+                auto height = get<int32_t>();
+                if (execute) createFramebuffer(id, tex, rbo, width, height);
+                break;
+            }
+            case TraceOp::BindFramebuffer: {
+                auto id = get<uint32_t>();
+                if (execute) glBindFramebuffer(GL_FRAMEBUFFER, lookup(framebuffers, id));
+                break;
+            }
+
+            case TraceOp::Enable: {
+                auto cap = get<uint32_t>();
+                if (execute) glEnable(cap);
+                break;
+            }
+            case TraceOp::Disable: {
+                auto cap = get<uint32_t>();
+                if (execute) glDisable(cap);
+                break;
+            }
+            case TraceOp::Clear: {
+                auto mask = get<uint32_t>();
+                if (execute) glClear(mask);
+                break;
+            }
+            case TraceOp::Viewport: {
+                auto x = get<int32_t>();
+                auto y = get<int32_t>();
+                auto width = get<int32_t>();
+                auto height = get<int32_t>();
+                if (execute) glViewport(x, y, width, height);
+                break;
+            }
+            case TraceOp::DrawElements: {
+                auto count = get<int32_t>();
+                if (execute) glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+                break;
+            }
+            case TraceOp::DepthFunc: {
+                auto func = get<uint32_t>();
+                if (execute) glDepthFunc(func);
+                break;
+            }
+            case TraceOp::DepthMask: {
+                auto enabled = get<uint8_t>();
+                if (execute) glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+                break;
+            }
+            case TraceOp::ColorMask: {
+                auto enabled = get<uint8_t>() ? GL_TRUE : GL_FALSE;
+                if (execute) glColorMask(enabled, enabled, enabled, enabled);
+                break;
+            }
+
+            default:
+                throw std::runtime_error("Unknown trace op " + std::to_string(static_cast<int>(op)));
+        }
+        return op;
+    }
+};
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace> [iterations] [warmup]" << std::endl;
+        return 1;
+    }
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 100;
+    int warmup = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    MappedFile file(argv[1]);
+    const unsigned char *begin = file.data();
+    const unsigned char *fileEnd = file.data() + file.size();
+    size_t headerSize = sizeof(traceMagic) + sizeof(uint32_t) + sizeof(uint8_t);
+    if (file.size() < headerSize || std::memcmp(begin, traceMagic, sizeof(traceMagic)) != 0) {
+        throw std::runtime_error("Not a GL trace: " + std::string(argv[1]));
+    }
+    uint32_t version;
+    std::memcpy(&version, begin + sizeof(traceMagic), sizeof(version));
+    if (version != traceVersion) {
+        throw std::runtime_error("Unsupported trace version " + std::to_string(version));
+    }
+    glBackend = static_cast<GLBackend>(begin[sizeof(traceMagic) + sizeof(version)]);
+    begin += headerSize;
+
+    // Dry pass: find the frame and the size of the default framebuffer it expects.
+    Replayer replayer(begin, fileEnd);
+    std::string marker;
+    const unsigned char *frameStart = nullptr;
+    int width = 640, height = 480;
+    bool sized = false;
+    while (replayer.tell() < fileEnd) {
+        const unsigned char *at = replayer.tell();
+        TraceOp op = replayer.step(false, marker);
+        if (op == TraceOp::FrameBegin) {
+            frameStart = at;
+        } else if (op == TraceOp::Viewport && frameStart && !sized) {
+            int32_t vals[4];
+            std::memcpy(vals, at + 1, sizeof(vals));
+            width = vals[2];
+            height = vals[3];
+            sized = true;
+        }
+    }
+    if (!frameStart) {
+        throw std::runtime_error("Trace has no captured frame");
+    }
+
+    if (!glfwInit()) {
+        throw std::runtime_error("GLFW initialization failed (no display? try xvfb-run)! Aborting!");
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if (glBackend == GLBackend::Core45) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+    }
+    GLFWwindow *win = glfwCreateWindow(width, height, "replay", nullptr, nullptr);
+    if (!win) { throw std::runtime_error("Window creation failed! Aborting!"); }
+    glfwMakeContextCurrent(win);
+
+    glewExperimental = true;
+    if (glewInit() != GLEW_OK) {
+        throw std::runtime_error("GLEW initialization failed! Aborting!");
+    }
+    flushErrors("glewInit");
+    std::cout << "Replaying " << argv[1] << " on " << glGetString(GL_RENDERER) << " ("
+              << (glBackend == GLBackend::Core45 ? "4.5 core" : "2.1 legacy") << ", " << width << "x" << height
+              << ")" << std::endl;
+
+    // Setup: everything up to FrameBegin, once
+    replayer.seek(begin);
+    while (replayer.tell() < frameStart) {
+        replayer.step(true, marker);
+    }
+    glFinish();
+    flushErrors("replay setup");
+
+    std::vector<TraceRange> ranges;
+    std::vector<double> frameMs;
+    using Clock = std::chrono::steady_clock;
+
+    for (int iter = 0; iter < warmup + iterations; iter++) {
+        bool measured = iter >= warmup;
+        bool first = iter == 0;
+        size_t range = 0;
+        if (first) {
+            ranges.push_back({"(frame start)"});
+        }
+
+        replayer.seek(frameStart);
+        auto frameBegin = Clock::now();
+        auto rangeBegin = frameBegin;
+
+        TraceOp op;
+        do {
+            op = replayer.step(true, marker);
+            if (op == TraceOp::Marker || op == TraceOp::FrameEnd) {
+                glFinish();
+                auto now = Clock::now();
+                if (measured) {
+                    ranges[range].ms.push_back(std::chrono::duration<double, std::milli>(now - rangeBegin).count());
+                }
+                rangeBegin = now;
+                if (op == TraceOp::Marker) {
+                    range++;
+                    if (first) {
+                        ranges.push_back({marker});
+                    }
+                }
+            } else if (first && op != TraceOp::FrameBegin) {
+                ranges[range].ops++;
+                ranges[range].draws += op == TraceOp::DrawElements;
+            }
+        } while (op != TraceOp::FrameEnd);
+
+        if (measured) {
+            frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameBegin).count());
+        }
+        flushErrors("replay frame");
+    }
+
+    auto report = [](const std::string &name, unsigned ops, unsigned draws, std::vector<double> ms) {
+        if (ms.empty()) {
+            return;
+        }
+        std::sort(ms.begin(), ms.end());
+        double mean = 0;
+        for (double val : ms) {
+            mean += val;
+        }
+        mean /= ms.size();
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(8) << ops << std::setw(8) << draws
+                  << std::fixed << std::setprecision(3) << std::setw(12) << mean << std::setw(12) << ms.front()
+                  << std::setw(12) << ms[ms.size() / 2] << std::setw(12) << ms.back() << std::endl;
+    };
+
+    std::cout << iterations << " iterations after " << warmup << " warmup" << std::endl;
+    std::cout << std::left << std::setw(16) << "range" << std::right << std::setw(8) << "ops" << std::setw(8)
+              << "draws" << std::setw(12) << "mean ms" << std::setw(12) << "min ms" << std::setw(12) << "median ms"
+              << std::setw(12) << "max ms" << std::endl;
+    unsigned totalOps = 0, totalDraws = 0;
+    for (const auto &range : ranges) {
+        report(range.name, range.ops, range.draws, range.ms);
+        totalOps += range.ops;
+        totalDraws += range.draws;
+    }
+    report("frame", totalOps, totalDraws, frameMs);
+
+    glfwDestroyWindow(win);
+    glfwTerminate();
+    return 0;
+}
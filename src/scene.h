@@ -0,0 +1,336 @@
+// Scene graph. Nodes are stored as flat arrays sorted by depth, so every parent comes before its children and a single
+// forward pass can propagate transforms. Only nodes whose own local matrix changed, or whose parent's world matrix
+// changed, are recomputed; a frame where nothing moved costs one branch.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "glm/gtx/euler_angles.hpp"
+
+typedef unsigned NodeHandle;
+
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+class SceneGraph {
+private:
+    // Per node data, indexed by slot (depth order). Handles stay valid across re-sorts through slotOf.
+    std::vector<int> parent;
+    std::vector<unsigned> depth;
+    std::vector<int> mesh;
+    std::vector<glm::mat4> local;
+    std::vector<glm::mat4> world;
+    std::vector<AABB> worldBounds;
+    std::vector<unsigned char> dirty;
+    std::vector<std::string> names;
+
+    std::vector<unsigned> slotOf;
+
+    std::vector<AABB> meshBounds;
+    std::unordered_map<std::string, int> meshIds;
+
+    unsigned firstDirty = ~0u;
+    bool sorted = true;
+
+    inline void markDirty(unsigned slot) {
+        dirty[slot] = 1;
+        firstDirty = std::min(firstDirty, slot);
+    }
+
+    // Arvo's method: transform the center, then the extents by |M|.
+    static AABB transformBounds(const glm::mat4 &m, const AABB &box) {
+        glm::vec3 center = (box.min + box.max) * 0.5f;
+        glm::vec3 extent = (box.max - box.min) * 0.5f;
+
+        glm::vec3 newCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+        glm::vec3 newExtent;
+        for (int i = 0; i < 3; i++) {
+            newExtent[i] = std::abs(m[0][i]) * extent.x + std::abs(m[1][i]) * extent.y + std::abs(m[2][i]) * extent.z;
+        }
+        return {newCenter - newExtent, newCenter + newExtent};
+    }
+
+    // Stable sort by depth. Siblings keep their load order, which is what draw order falls back to.
+    void sortByDepth() {
+        std::vector<unsigned> order(parent.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) { return depth[a] < depth[b]; });
+
+        std::vector<unsigned> newSlot(order.size());
+        for (unsigned i = 0; i < order.size(); i++) {
+            newSlot[order[i]] = i;
+        }
+
+        auto permute = [&](auto &vec) {
+            auto old = vec;
+            for (unsigned i = 0; i < order.size(); i++) {
+                vec[i] = old[order[i]];
+            }
+        };
+        permute(parent);
+        permute(depth);
+        permute(mesh);
+        permute(local);
+        permute(world);
+        permute(worldBounds);
+        permute(dirty);
+        permute(names);
+
+        for (auto &p : parent) {
+            if (p >= 0) {
+                p = newSlot[p];
+            }
+        }
+        for (auto &slot : slotOf) {
+            slot = newSlot[slot];
+        }
+
+        firstDirty = 0;
+        sorted = true;
+    }
+
+    // Handle of the node called `name`, or -1
+    [[nodiscard]] int lookup(const std::string &name) const {
+        for (NodeHandle handle = 0; handle < slotOf.size(); handle++) {
+            if (names[slotOf[handle]] == name) {
+                return static_cast<int>(handle);
+            }
+        }
+        return -1;
+    }
+
+    [[nodiscard]] NodeHandle resolve(const std::string &name, const std::string &file) const {
+        int handle = lookup(name);
+        if (handle < 0) {
+            throw std::runtime_error("Unknown parent node '" + name + "' in " + file);
+        }
+        return handle;
+    }
+
+    [[nodiscard]] int resolveMesh(const std::string &name, const std::string &file) const {
+        if (name == "-") {
+            return -1;
+        }
+        auto iter = meshIds.find(name);
+        if (iter == meshIds.end()) {
+            throw std::runtime_error("Unknown mesh '" + name + "' in " + file);
+        }
+        return iter->second;
+    }
+
+public:
+    SceneGraph() = default;
+
+    /**
+     * Registers a mesh so scene files can refer to it by name. `bounds` is in model space.
+     */
+    int addMesh(const std::string &name, AABB bounds) {
+        meshBounds.emplace_back(bounds);
+        meshIds[name] = static_cast<int>(meshBounds.size() - 1);
+        return meshIds[name];
+    }
+
+    NodeHandle addNode(const std::string &name, int parentHandle, int meshId, const glm::mat4 &mat) {
+        NodeHandle handle = slotOf.size();
+        unsigned slot = parent.size();
+        int parentSlot = parentHandle >= 0 ? static_cast<int>(slotOf[parentHandle]) : -1;
+
+        parent.emplace_back(parentSlot);
+        depth.emplace_back(parentSlot >= 0 ? depth[parentSlot] + 1 : 0);
+        mesh.emplace_back(meshId);
+        local.emplace_back(mat);
+        world.emplace_back(1.0f);
+        worldBounds.push_back({});
+        dirty.emplace_back(0);
+        names.emplace_back(name);
+        slotOf.emplace_back(slot);
+
+        markDirty(slot);
+        if (slot > 0 && depth[slot] < depth[slot - 1]) {
+            sorted = false;
+        }
+        return handle;
+    }
+
+    inline void setLocal(NodeHandle handle, const glm::mat4 &mat) {
+        local[slotOf[handle]] = mat;
+        markDirty(slotOf[handle]);
+    }
+
+    [[nodiscard]] inline const glm::mat4 &getLocal(NodeHandle handle) const {
+        return local[slotOf[handle]];
+    }
+
+    [[nodiscard]] inline const glm::mat4 &getWorld(NodeHandle handle) const {
+        return world[slotOf[handle]];
+    }
+
+    [[nodiscard]] NodeHandle find(const std::string &name) const {
+        int handle = lookup(name);
+        if (handle < 0) {
+            throw std::runtime_error("No node named '" + name + "' in the scene");
+        }
+        return handle;
+    }
+
+    [[nodiscard]] inline size_t size() const {
+        return parent.size();
+    }
+
+    /**
+     * Recomputes world matrices and bounds for dirty subtrees. Returns the number of nodes recomputed.
+     */
+    unsigned update() {
+        if (!sorted) {
+            sortByDepth();
+        }
+        if (firstDirty >= parent.size()) {
+            return 0;
+        }
+
+        unsigned recomputed = 0;
+        for (unsigned slot = firstDirty; slot < parent.size(); slot++) {
+            int p = parent[slot];
+            if (p >= 0 && dirty[p]) {
+                dirty[slot] = 1;
+            }
+            if (!dirty[slot]) {
+                continue;
+            }
+
+            world[slot] = p >= 0 ? world[p] * local[slot] : local[slot];
+            if (mesh[slot] >= 0) {
+                worldBounds[slot] = transformBounds(world[slot], meshBounds[mesh[slot]]);
+            }
+            recomputed++;
+        }
+
+        std::fill(dirty.begin() + firstDirty, dirty.end(), 0);
+        firstDirty = ~0u;
+        return recomputed;
+    }
+
+    /**
+     * Appends every node with a mesh whose cached world bounds intersect the frustum of `viewProj`. Each entry is
+     * (mesh id, world matrix).
+     */
+    void collectVisible(const glm::mat4 &viewProj, std::vector<std::pair<int, const glm::mat4 *>> &out) const {
+        // Gribb/Hartmann plane extraction; glm matrices are column major so rows are m[0][i]..m[3][i].
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++) {
+            rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+        }
+        glm::vec4 planes[6] = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                               rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+
+        for (unsigned slot = 0; slot < parent.size(); slot++) {
+            if (mesh[slot] < 0) {
+                continue;
+            }
+
+            const AABB &box = worldBounds[slot];
+            bool inside = true;
+            for (const auto &plane : planes) {
+                // Farthest corner along the plane normal
+                glm::vec3 corner = {plane.x > 0 ? box.max.x : box.min.x,
+                                    plane.y > 0 ? box.max.y : box.min.y,
+                                    plane.z > 0 ? box.max.z : box.min.z};
+                if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0) {
+                    inside = false;
+                    break;
+                }
+            }
+
+            if (inside) {
+                out.emplace_back(mesh[slot], &world[slot]);
+            }
+        }
+    }
+
+    /**
+     * Loads nodes from a scene file. Meshes must already be registered with addMesh. Format, one record per line:
+     *
+     *   node <name> <parent|-> <mesh|-> <tx> <ty> <tz> <yaw> <pitch> <roll> <scale>
+     *   grid <name> <parent|-> <mesh|-> <nx> <ny> <nz> <spacing> <ox> <oy> <oz> [random]
+     *
+     * Angles are in degrees. `grid` lays out nx*ny*nz children named <name>0, <name>1, ... (x fastest, then y, then
+     * z) starting at <ox> <oy> <oz>, each with a random orientation if `random` is given.
+     * Lines starting with '#' are comments.
+     */
+    void load(const std::string &file) {
+        std::ifstream fp(file);
+        if (!fp.is_open()) {
+            throw std::runtime_error("Failed to read " + file);
+        }
+
+        std::random_device seeder;
+        std::default_random_engine randEngine(seeder());
+        auto radianDist = std::uniform_real_distribution<float>(0, 2 * 3.14159265);
+
+        std::string line;
+        while (std::getline(fp, line)) {
+            std::istringstream in(line);
+            std::string kind, name, parentName, meshName;
+            if (!(in >> kind) || kind[0] == '#') {
+                continue;
+            }
+            if (!(in >> name >> parentName >> meshName)) {
+                throw std::runtime_error("Malformed line in " + file + ": " + line);
+            }
+
+            int parentHandle = parentName == "-" ? -1 : static_cast<int>(resolve(parentName, file));
+            int meshId = resolveMesh(meshName, file);
+
+            if (kind == "node") {
+                glm::vec3 pos, angles;
+                float scale;
+                if (!(in >> pos.x >> pos.y >> pos.z >> angles.x >> angles.y >> angles.z >> scale)) {
+                    throw std::runtime_error("Malformed node in " + file + ": " + line);
+                }
+
+                glm::mat4 mat = glm::translate(glm::mat4(1.0f), pos) *
+                                glm::scale(glm::mat4(1.0f), glm::vec3(scale)) *
+                                glm::eulerAngleYXZ(glm::radians(angles.x), glm::radians(angles.y),
+                                                   glm::radians(angles.z));
+                addNode(name, parentHandle, meshId, mat);
+            } else if (kind == "grid") {
+                int nx, ny, nz;
+                float spacing;
+                glm::vec3 origin;
+                std::string flag;
+                if (!(in >> nx >> ny >> nz >> spacing >> origin.x >> origin.y >> origin.z)) {
+                    throw std::runtime_error("Malformed grid in " + file + ": " + line);
+                }
+                bool randomize = (in >> flag) && flag == "random";
+
+                for (int i = 0; i < nx * ny * nz; i++) {
+                    glm::mat4 mat(1.0f);
+                    if (randomize) {
+                        mat = glm::eulerAngleYXZ(radianDist(randEngine), radianDist(randEngine),
+                                                 radianDist(randEngine));
+                    }
+                    glm::vec3 cell = glm::vec3(static_cast<float>(i % nx), static_cast<float>((i / nx) % ny),
+                                               static_cast<float>(i / (nx * ny))) * spacing;
+                    mat = glm::translate(glm::mat4(1.0f), origin + cell) * mat;
+                    addNode(name + std::to_string(i), parentHandle, meshId, mat);
+                }
+            } else {
+                throw std::runtime_error("Unknown record '" + kind + "' in " + file);
+            }
+        }
+    }
+};
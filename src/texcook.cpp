@@ -0,0 +1,168 @@
+// Offline texture cooker. Decodes an image once, builds the full mip chain and writes it out as KTX so the game
+// never has to run stbi_load or glGenerateMipmap at startup.
+//
+// Usage: texcook <input image> [output stem]
+// Writes <stem>.ktx (RGBA8) and <stem>.s3tc.ktx (DXT1, or DXT5 if the image has alpha). The stem defaults to the
+// input path without its extension, which is where Texture looks for them.
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_DXT_IMPLEMENTATION
+
+#include <stb/stb_image.h>
+#include <stb/stb_dxt.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "ktx.h"
+
+struct MipLevel {
+    int width;
+    int height;
+    std::vector<unsigned char> rgba;
+};
+
+struct FilterTaps {
+    int count;
+    int index[3];
+    float weight[3];
+};
+
+// Source texels (and their weights) covering destination texel `dst` along one axis. Even sizes are a plain 2-tap
+// box. Odd sizes use 3 taps weighted by how much of each source texel falls in the destination's footprint, so the
+// last row/column is still sampled instead of being dropped.
+FilterTaps filterTaps(int dst, int srcSize, int dstSize) {
+    if (srcSize == 1) {
+        return {1, {0}, {1.0f}};
+    }
+    if (srcSize % 2 == 0) {
+        return {2, {dst * 2, dst * 2 + 1}, {0.5f, 0.5f}};
+    }
+    float size = static_cast<float>(srcSize);
+    return {3, {dst * 2, dst * 2 + 1, dst * 2 + 2},
+            {static_cast<float>(dstSize - dst) / size, static_cast<float>(dstSize) / size,
+             static_cast<float>(dst + 1) / size}};
+}
+
+// Halves each dimension (down to 1) with an area-weighted box filter.
+MipLevel downsample(const MipLevel &src) {
+    MipLevel dst{std::max(1, src.width / 2), std::max(1, src.height / 2), {}};
+    dst.rgba.resize(dst.width * dst.height * 4);
+
+    for (int y = 0; y < dst.height; y++) {
+        FilterTaps rows = filterTaps(y, src.height, dst.height);
+        for (int x = 0; x < dst.width; x++) {
+            FilterTaps cols = filterTaps(x, src.width, dst.width);
+            for (int c = 0; c < 4; c++) {
+                float sum = 0;
+                for (int j = 0; j < rows.count; j++) {
+                    for (int i = 0; i < cols.count; i++) {
+                        sum += rows.weight[j] * cols.weight[i] *
+                               src.rgba[(rows.index[j] * src.width + cols.index[i]) * 4 + c];
+                    }
+                }
+                dst.rgba[(y * dst.width + x) * 4 + c] = static_cast<unsigned char>(std::min(255.0f, sum + 0.5f));
+            }
+        }
+    }
+    return dst;
+}
+
+std::vector<unsigned char> compressDxt(const MipLevel &level, bool alpha) {
+    int blocksX = (level.width + 3) / 4;
+    int blocksY = (level.height + 3) / 4;
+    int blockSize = alpha ? 16 : 8;
+    std::vector<unsigned char> out(blocksX * blocksY * blockSize);
+
+    unsigned char block[16 * 4];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            // Levels smaller than 4x4 (and ragged edges) repeat their last row/column into the block.
+            for (int py = 0; py < 4; py++) {
+                int y = std::min(by * 4 + py, level.height - 1);
+                for (int px = 0; px < 4; px++) {
+                    int x = std::min(bx * 4 + px, level.width - 1);
+                    std::memcpy(&block[(py * 4 + px) * 4], &level.rgba[(y * level.width + x) * 4], 4);
+                }
+            }
+            stb_compress_dxt_block(&out[(by * blocksX + bx) * blockSize], block, alpha ? 1 : 0, STB_DXT_HIGHQUAL);
+        }
+    }
+    return out;
+}
+
+void writeKtx(const std::string &filename, uint32_t glType, uint32_t glFormat, uint32_t internalFormat,
+              uint32_t baseFormat, const std::vector<MipLevel> &mips,
+              const std::vector<std::vector<unsigned char>> &images) {
+    KtxHeader header{};
+    std::memcpy(header.identifier, ktxIdentifier, sizeof(ktxIdentifier));
+    header.endianness = ktxEndianRef;
+    header.glType = glType;
+    header.glTypeSize = 1;
+    header.glFormat = glFormat;
+    header.glInternalFormat = internalFormat;
+    header.glBaseInternalFormat = baseFormat;
+    header.pixelWidth = mips[0].width;
+    header.pixelHeight = mips[0].height;
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = mips.size();
+
+    std::ofstream fp(filename, std::ios::binary);
+    if (!fp.is_open()) {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+
+    fp.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    const char padding[4] = {};
+    for (const auto &image : images) {
+        uint32_t imageSize = image.size();
+        fp.write(reinterpret_cast<const char *>(&imageSize), sizeof(imageSize));
+        fp.write(reinterpret_cast<const char *>(image.data()), image.size());
+        fp.write(padding, ktxPad4(imageSize) - imageSize);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input image> [output stem]" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string stem = argc > 2 ? argv[2] : std::filesystem::path(input).replace_extension().string();
+
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(input.c_str(), &width, &height, &nrChannels, 4);
+    if (!data) {
+        std::cerr << "Failed to load " << input << ": " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+
+    std::vector<MipLevel> mips;
+    mips.push_back({width, height, std::vector<unsigned char>(data, data + width * height * 4)});
+    stbi_image_free(data);
+
+    while (mips.back().width > 1 || mips.back().height > 1) {
+        mips.push_back(downsample(mips.back()));
+    }
+
+    bool alpha = nrChannels == 2 || nrChannels == 4;
+
+    std::vector<std::vector<unsigned char>> raw, dxt;
+    for (const auto &mip : mips) {
+        raw.push_back(mip.rgba);
+        dxt.push_back(compressDxt(mip, alpha));
+    }
+
+    writeKtx(stem + ".ktx", ktxUnsignedByte, ktxRGBA, ktxRGBA8, ktxRGBA, mips, raw);
+    writeKtx(stem + ".s3tc.ktx", 0, 0, alpha ? ktxDXT5 : ktxDXT1, alpha ? ktxRGBA : ktxRGB, mips, dxt);
+
+    std::cout << "Cooked " << input << " (" << width << "x" << height << ", " << mips.size() << " levels) -> "
+              << stem << ".ktx, " << stem << ".s3tc.ktx" << std::endl;
+    return 0;
+}
@@ -0,0 +1,415 @@
+// GL command-stream capture. When a GLTrace is installed in glTrace, the wrappers in abstract.cpp report every call
+// they make to it. Resource creation and uploads (buffers, textures, shaders, framebuffers) are always kept so the
+// trace is self contained; per-frame state and draw calls are only kept for the captured frame. The result is written
+// as one binary file that the replay tool (src/replay.cpp) re-executes headlessly.
+//
+// File layout: "GLTR", uint32 version, uint8 backend, then a stream of [uint8 TraceOp][payload]. Everything before
+// FrameBegin is setup, everything between FrameBegin and FrameEnd is the frame. Strings and blobs are a uint32
+// length followed by the bytes. All values are little endian, host layout.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr char traceMagic[4] = {'G', 'L', 'T', 'R'};
+constexpr uint32_t traceVersion = 3;
+
+enum class TraceOp : uint8_t {
+    FrameBegin,
+    FrameEnd,
+    Marker, // string name; starts a new timing range in the replay
+
+    CreateBuffer, // u32 id, u32 target, blob data
+    BindBuffer, // u32 target, u32 id
+    CreateUniformBuffer, // u32 id, u32 binding, u32 size
+    UniformBufferData, // u32 id, blob data
+
+    CreateVertexArray, // u32 id
+    BindVertexArray, // u32 id
+    AttribPointers, // u32 stride, u32 count, count * (u32 index, u32 size, u32 offset)
+
+    ShaderSource, // u32 id, u8 isVert, string source
+    CreateProgram, // u32 id
+    AttachShader, // u32 program, u32 shader
+    BindAttribLocation, // u32 program, u32 index, string name
+    LinkProgram, // u32 program
+    UseProgram, // u32 program
+    UniformLocation, // u32 program, string name, i32 location
+    UniformMat4, // i32 location, 16 floats
+    Uniform1fv, // i32 location, u32 count, count floats
+    Uniform1i, // i32 location, i32 value
+
+    CreateTexture, // u32 id
+    BindTexture, // u32 id
+    TexParam, // u32 id, u32 pname, i32 value
+    TexStorage, // u32 id, i32 levels, u32 internalFormat, i32 width, i32 height
+    TexImage, // u32 id, i32 level, u32 internalFormat, i32 width, i32 height, u32 format, u32 type, u8 flags,
+              // i32 alignment, blob pixels
+    GenerateMipmap, // u32 id
+
+    CreateFramebuffer, // u32 id, u32 tex, u32 rbo, i32 width, i32 height
+    BindFramebuffer, // u32 id
+
+    Enable, // u32 cap
+    Disable, // u32 cap
+    Clear, // u32 mask
+    Viewport, // i32 x, i32 y, i32 width, i32 height
+    DrawElements, // i32 count
+
+    DepthFunc, // u32 func
+    DepthMask, // u8 enabled
+    ColorMask, // u8 enabled (all four channels)
+
+    VertexArrayLayout, // u32 vao, u32 vbo, u32 ibo, u32 stride, u32 count, count * (u32 index, u32 size, u32 offset)
+};
+
+// TexImage flags
+constexpr uint8_t traceTexCompressed = 1; // pixels are a compressed block stream
+constexpr uint8_t traceTexSubImage = 2; // storage was allocated by TexStorage; upload with (Compressed)TexSubImage
+
+class GLTrace {
+private:
+    std::string filename;
+    uint8_t backend;
+
+    std::vector<unsigned char> setup;
+    std::vector<unsigned char> frame;
+
+    bool started = false; // a frame has begun; per-frame state stops going into setup
+    bool armed = false;
+    bool capturing = false;
+    std::vector<unsigned char> *out{};
+
+    template<typename T>
+    inline void put(T val) {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(&val);
+        out->insert(out->end(), bytes, bytes + sizeof(T));
+    }
+
+    inline void putBlob(const void *data, size_t len) {
+        put<uint32_t>(len);
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        out->insert(out->end(), bytes, bytes + len);
+    }
+
+    inline void putString(const std::string &str) {
+        putBlob(str.data(), str.size());
+    }
+
+    // Resources always go to setup so the replay creates them once, even if they were made mid-frame.
+    inline void resource(TraceOp op) {
+        out = &setup;
+        put(op);
+    }
+
+    // Per-frame state is kept before the first frame (it's part of setup) and during the captured frame.
+    inline bool state(TraceOp op) {
+        if (capturing) {
+            out = &frame;
+        } else if (!started) {
+            out = &setup;
+        } else {
+            return false;
+        }
+        put(op);
+        return true;
+    }
+
+public:
+    GLTrace(std::string filename, uint8_t backend) : filename(std::move(filename)), backend(backend) {}
+
+    // Captures the next whole frame (beginFrame to endFrame) and writes the file when it ends.
+    inline void arm() {
+        armed = true;
+    }
+
+    [[nodiscard]] inline bool isCapturing() const {
+        return capturing;
+    }
+
+    void beginFrame() {
+        started = true;
+        if (armed && !capturing) {
+            armed = false;
+            capturing = true;
+            frame.clear();
+            out = &frame;
+            put(TraceOp::FrameBegin);
+        }
+    }
+
+    void endFrame() {
+        if (!capturing) {
+            return;
+        }
+        out = &frame;
+        put(TraceOp::FrameEnd);
+        capturing = false;
+
+        std::ofstream fp(filename, std::ios::binary);
+        if (!fp.is_open()) {
+            throw std::runtime_error("Failed to write " + filename);
+        }
+        fp.write(traceMagic, sizeof(traceMagic));
+        fp.write(reinterpret_cast<const char *>(&traceVersion), sizeof(traceVersion));
+        fp.write(reinterpret_cast<const char *>(&backend), sizeof(backend));
+        fp.write(reinterpret_cast<const char *>(setup.data()), setup.size());
+        fp.write(reinterpret_cast<const char *>(frame.data()), frame.size());
+
+        std::cout << "Captured frame to " << filename << " (" << setup.size() << " bytes setup, " << frame.size()
+                  << " bytes frame)" << std::endl;
+    }
+
+    void marker(const std::string &name) {
+        if (capturing && state(TraceOp::Marker)) {
+            putString(name);
+        }
+    }
+
+    void createBuffer(uint32_t id, uint32_t target, const void *data, size_t len) {
+        resource(TraceOp::CreateBuffer);
+        put(id);
+        put(target);
+        putBlob(data, len);
+    }
+
+    void bindBuffer(uint32_t target, uint32_t id) {
+        if (state(TraceOp::BindBuffer)) {
+            put(target);
+            put(id);
+        }
+    }
+
+    void createUniformBuffer(uint32_t id, uint32_t binding, uint32_t size) {
+        resource(TraceOp::CreateUniformBuffer);
+        put(id);
+        put(binding);
+        put(size);
+    }
+
+    void uniformBufferData(uint32_t id, const void *data, size_t len) {
+        if (state(TraceOp::UniformBufferData)) {
+            put(id);
+            putBlob(data, len);
+        }
+    }
+
+    void createVertexArray(uint32_t id) {
+        resource(TraceOp::CreateVertexArray);
+        put(id);
+    }
+
+    void bindVertexArray(uint32_t id) {
+        if (state(TraceOp::BindVertexArray)) {
+            put(id);
+        }
+    }
+
+    void attribPointers(uint32_t stride, const std::vector<uint32_t> &indexSizeOffset) {
+        if (state(TraceOp::AttribPointers)) {
+            put(stride);
+            put<uint32_t>(indexSizeOffset.size() / 3);
+            for (auto val : indexSizeOffset) {
+                put(val);
+            }
+        }
+    }
+
+    void vertexArrayLayout(uint32_t vao, uint32_t vbo, uint32_t ibo, uint32_t stride,
+                           const std::vector<uint32_t> &indexSizeOffset) {
+        resource(TraceOp::VertexArrayLayout);
+        put(vao);
+        put(vbo);
+        put(ibo);
+        put(stride);
+        put<uint32_t>(indexSizeOffset.size() / 3);
+        for (auto val : indexSizeOffset) {
+            put(val);
+        }
+    }
+
+    void shaderSource(uint32_t id, bool isVert, const std::string &source) {
+        resource(TraceOp::ShaderSource);
+        put(id);
+        put<uint8_t>(isVert);
+        putString(source);
+    }
+
+    void createProgram(uint32_t id) {
+        resource(TraceOp::CreateProgram);
+        put(id);
+    }
+
+    void attachShader(uint32_t program, uint32_t shader) {
+        resource(TraceOp::AttachShader);
+        put(program);
+        put(shader);
+    }
+
+    void bindAttribLocation(uint32_t program, uint32_t index, const std::string &name) {
+        resource(TraceOp::BindAttribLocation);
+        put(program);
+        put(index);
+        putString(name);
+    }
+
+    void linkProgram(uint32_t program) {
+        resource(TraceOp::LinkProgram);
+        put(program);
+    }
+
+    void useProgram(uint32_t program) {
+        if (state(TraceOp::UseProgram)) {
+            put(program);
+        }
+    }
+
+    void uniformLocation(uint32_t program, const std::string &name, int32_t location) {
+        resource(TraceOp::UniformLocation);
+        put(program);
+        putString(name);
+        put(location);
+    }
+
+    void uniformMat4(int32_t location, const float *vals) {
+        if (state(TraceOp::UniformMat4)) {
+            put(location);
+            for (int i = 0; i < 16; i++) {
+                put(vals[i]);
+            }
+        }
+    }
+
+    void uniform1fv(int32_t location, const float *vals, uint32_t count) {
+        if (state(TraceOp::Uniform1fv)) {
+            put(location);
+            put(count);
+            for (uint32_t i = 0; i < count; i++) {
+                put(vals[i]);
+            }
+        }
+    }
+
+    void uniform1i(int32_t location, int32_t val) {
+        if (state(TraceOp::Uniform1i)) {
+            put(location);
+            put(val);
+        }
+    }
+
+    void createTexture(uint32_t id) {
+        resource(TraceOp::CreateTexture);
+        put(id);
+    }
+
+    void bindTexture(uint32_t id) {
+        if (state(TraceOp::BindTexture)) {
+            put(id);
+        }
+    }
+
+    void texParam(uint32_t id, uint32_t pname, int32_t val) {
+        resource(TraceOp::TexParam);
+        put(id);
+        put(pname);
+        put(val);
+    }
+
+    void texStorage(uint32_t id, int32_t levels, uint32_t internalFormat, int32_t width, int32_t height) {
+        resource(TraceOp::TexStorage);
+        put(id);
+        put(levels);
+        put(internalFormat);
+        put(width);
+        put(height);
+    }
+
+    void texImage(uint32_t id, int32_t level, uint32_t internalFormat, int32_t width, int32_t height, uint32_t format,
+                  uint32_t type, uint8_t flags, int32_t alignment, const void *pixels, size_t len) {
+        resource(TraceOp::TexImage);
+        put(id);
+        put(level);
+        put(internalFormat);
+        put(width);
+        put(height);
+        put(format);
+        put(type);
+        put(flags);
+        put(alignment);
+        putBlob(pixels, len);
+    }
+
+    void generateMipmap(uint32_t id) {
+        resource(TraceOp::GenerateMipmap);
+        put(id);
+    }
+
+    void createFramebuffer(uint32_t id, uint32_t tex, uint32_t rbo, int32_t width, int32_t height) {
+        resource(TraceOp::CreateFramebuffer);
+        put(id);
+        put(tex);
+        put(rbo);
+        put(width);
+        put(height);
+    }
+
+    void bindFramebuffer(uint32_t id) {
+        if (state(TraceOp::BindFramebuffer)) {
+            put(id);
+        }
+    }
+
+    void capability(uint32_t cap, bool enabled) {
+        if (state(enabled ? TraceOp::Enable : TraceOp::Disable)) {
+            put(cap);
+        }
+    }
+
+    void clear(uint32_t mask) {
+        if (state(TraceOp::Clear)) {
+            put(mask);
+        }
+    }
+
+    void viewport(int32_t x, int32_t y, int32_t width, int32_t height) {
+        if (state(TraceOp::Viewport)) {
+            put(x);
+            put(y);
+            put(width);
+            put(height);
+        }
+    }
+
+    void depthFunc(uint32_t func) {
+        if (state(TraceOp::DepthFunc)) {
+            put(func);
+        }
+    }
+
+    void depthMask(bool enabled) {
+        if (state(TraceOp::DepthMask)) {
+            put<uint8_t>(enabled);
+        }
+    }
+
+    void colorMask(bool enabled) {
+        if (state(TraceOp::ColorMask)) {
+            put<uint8_t>(enabled);
+        }
+    }
+
+    void drawElements(int32_t count) {
+        if (state(TraceOp::DrawElements)) {
+            put(count);
+        }
+    }
+};
+
+// Installed by main() when started with --capture. Null means tracing is off and the wrappers skip it entirely.
+inline GLTrace *glTrace = nullptr;